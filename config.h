@@ -3,19 +3,52 @@
 
 // ===== LCD 2004 I2C =====
 constexpr uint8_t LCD_I2C_ADDR = 0x27;   // поменяй на 0x3F если у тебя так
+constexpr uint32_t LCD_I2C_HZ = 100000UL; // PCF8574: не больше 100 кГц
+constexpr uint8_t LCD_TX_QUEUE = 128;     // байт LCD в очереди ISR (степень 2)
+constexpr uint8_t LCD_LOOP_BUDGET = 48;   // байт LCD, которые кадр UI ставит в очередь за проход loop()
 
 // ===== POT =====
 constexpr uint8_t PIN_POT = A0;
+constexpr uint8_t POT_RING = 16;          // отсчётов АЦП в кольце (степень 2, >= 16)
+// Шум потенциометра в отсчётах potGetAvgAdc() (0..4092): разница меньше —
+// полное сглаживание, каждое удвоение сверх — окно фильтра вдвое короче
+constexpr uint16_t POT_FILT_NOISE = 8;
 
 // ===== START button + LED =====
 constexpr uint8_t PIN_START_BTN = A1;    // кнопка START/STOP (NO) -> GND
 constexpr uint8_t PIN_START_LED = A2;    // LED кнопки START
 
 // ===== DM556 =====
+// Генерация STEP:
+//  1 = аппаратно: Timer1 сам переключает OC1A (D9) по совпадению, CPU не тратится
+//  0 = программно: ISR + digitalWrite на любом пине (лимит ~2 кГц)
+#define PUMP_STEP_HW 1
+
+#if PUMP_STEP_HW
+constexpr uint8_t PIN_STEP = 9;           // PUL+ (OC1A, только D9!)
+#else
 constexpr uint8_t PIN_STEP = 12;          // PUL+
+#endif
 constexpr uint8_t PIN_DIR  = 10;         // DIR+
 constexpr uint8_t PIN_ENA  = 11;         // ENA+
 
+// Максимальная частота шагов, Гц. DM556 принимает до 200 кГц,
+// программному ISR больше ~2 кГц давать нельзя (съедает loop()).
+constexpr uint32_t PUMP_MAX_STEP_HZ = PUMP_STEP_HW ? 100000UL : 2000UL;
+
+// HW режим: до этой частоты фронтов (2 на шаг) дробная часть периода (DDS)
+// досчитывается коротким ISR; выше — период округляется до тика без ISR
+constexpr uint32_t PUMP_DDS_MAX_CMP_HZ = 20000UL;
+
+// Разгон/торможение (ускорение задаётся в меню, 0 = без рампы)
+constexpr uint32_t PUMP_RAMP_START_HZ = 200;  // с этой частоты мотор стартует без рампы
+// Ступень скорости рампы: Timer1 перезаряжается, когда прямая разгона уйдёт
+// на столько от прошлой ступени (чаще — больше 32-битных делений в ISR)
+constexpr uint32_t PUMP_RAMP_LEVEL_HZ = 50;
+// Таблица POT -> частота/период в RUN: отрезков по шкале АЦП (16/32/64,
+// 8 байт RAM на узел). Больше отрезков — точнее период между узлами
+constexpr uint8_t  PUMP_LUT_SEGS = 32;
+
 // ===== INPUT (KY-040 encoder via EncButton v3) =====
 // Encoder pins (KY-040): S1->D2, S2->D12, BTN->A3
 constexpr uint8_t PIN_BTN_UP   = 2;       // ENC A (S1)  (to GND via encoder)
@@ -36,20 +69,48 @@ constexpr bool ENC_INVERT_DIR = true;
 // (для KY-040 помогает убрать "фантомные" шаги)
 constexpr uint16_t ENC_MIN_EDGE_US = 300; // 200..800 мкс, начните с 300
 
-// Минимальная пауза между ВЫДАННЫМИ шагами (не между переходами)
-constexpr uint8_t ENC_STEP_GUARD_MS = 2; // 0..5 мс
+// Ускорение: чем короче интервал между щелчками (меряется в ISR), тем
+// больше множитель шага числового поля. Пороги по убыванию интервала.
+constexpr uint8_t  ENC_ACCEL_LEVELS = 4;
+constexpr uint16_t ENC_ACCEL_DT_MS[ENC_ACCEL_LEVELS] = { 100, 60, 35, 20 }; // щелчок быстрее, мс
+constexpr uint8_t  ENC_ACCEL_MULT[ENC_ACCEL_LEVELS]  = {   2,  5, 10, 25 }; // -> шаг поля x N
+// Весь диапазон поля не проходится быстрее, чем за столько щелчков
+// (иначе короткие диапазоны, как диаметр 3..50, скачут от края до края)
+constexpr uint8_t  ENC_ACCEL_MIN_SWEEP = 10;
 
-// Кнопка энкодера (OK)
-constexpr uint8_t ENC_BTN_DEBOUNCE_MS = 25; // 15..40 мс
+// Кнопки (OK энкодера, START): общий антидребезг на вертикальных
+// счётчиках, опрос из прерывания Timer0 COMPA (~1 мс). Состояние
+// принимается после 4 одинаковых опросов подряд: 4 * BTN_SAMPLE_MS мс.
+constexpr uint8_t BTN_SAMPLE_MS = 8;        // 4..10 -> антидребезг 16..40 мс
 constexpr uint16_t ENC_BTN_LONG_MS = 600;   // длительное нажатие, мс
 
+// Очередь событий ввода ISR -> loop() (щелчки, нажатия/отпускания)
+constexpr uint8_t INPUT_QUEUE = 32;         // событий, степень 2 (4 байта RAM каждое)
+
 // Old MENU button is no longer used (BACK/MENU = encoder hold).
 // Leave pin defined but do not connect anything to it:
 constexpr uint8_t PIN_BTN_MENU = 4;       // (unused)
 
+// ===== EEPROM (1 КБ) =====
+// Настройки и общий счёт масла — два журнала (eestore): запись идёт по кругу
+// в следующий слот, износ делится на число слотов
+constexpr uint8_t  EE_LOG_SLOT_SIZE = 64;   // байт на запись (заголовок 5 + Settings)
+constexpr uint8_t  EE_LOG_SLOTS     = 15;   // 15 * 64 = 960 байт с адреса 0
+constexpr uint8_t  EE_TOTAL_SLOT_SIZE = 9;  // заголовок 5 + мл x100
+constexpr uint8_t  EE_TOTAL_SLOTS     = 7;  // 7 * 9 = 63 байта сразу за настройками
+
+// ===== Профилирование =====
+// 1 = замеры времени loop(), задач и ISR (prof.h): экран "Diagnostics" в
+// меню и команды в Serial ('p' — таблица, 'r' — сброс). ~260 байт RAM.
+// 0 = профайлер не компилируется вовсе.
+#define PROF_ENABLE 0
+
 // ===== Тайминги =====
-constexpr uint16_t INPUT_POLL_MS = 5;
-constexpr uint16_t UI_REFRESH_MS = 200;
+constexpr uint16_t INPUT_POLL_MS = 5;     // энкодер/кнопки и потенциометр
+constexpr uint16_t PUMP_TASK_MS = 1;      // обновление частоты насоса
+constexpr uint16_t PERSIST_TASK_MS = 10;  // фоновая запись EEPROM
+constexpr uint16_t UI_TASK_MS = 10;       // проверка "есть что рисовать"
+constexpr uint16_t UI_MIN_FRAME_MS = 40;  // UI перерисовывается по изменению, не чаще 25 кадров/с
 // =====================
 // UI language selection
 // =====================
@@ -0,0 +1,177 @@
+#include <EEPROM.h>
+#include <util/crc16.h>
+#include <string.h>
+#include "config.h"
+#include "eestore.h"
+
+static constexpr uint8_t HDR_SIZE = 5;
+
+struct LogArea {
+  uint16_t base;
+  uint8_t  slotSize;
+  uint8_t  slots;
+};
+
+static constexpr uint16_t TOTAL_BASE = (uint16_t)EE_LOG_SLOTS * EE_LOG_SLOT_SIZE;
+static const LogArea LOGS[EE_LOG_COUNT] = {
+  { 0,          EE_LOG_SLOT_SIZE,   EE_LOG_SLOTS },
+  { TOTAL_BASE, EE_TOTAL_SLOT_SIZE, EE_TOTAL_SLOTS },
+};
+static_assert(TOTAL_BASE + (uint16_t)EE_TOTAL_SLOTS * EE_TOTAL_SLOT_SIZE <= E2END + 1,
+              "oil total log out of EEPROM");
+static_assert(EE_TOTAL_SLOT_SIZE > HDR_SIZE && EE_TOTAL_SLOT_SIZE <= EE_LOG_SLOT_SIZE,
+              "oil total slot size");
+static_assert(EE_TOTAL_SLOTS <= EE_LOG_SLOTS, "eeStoreLoad scans up to EE_LOG_SLOTS");
+
+// куда писали последний раз
+static uint8_t  lastSlot[EE_LOG_COUNT] = { EE_LOG_SLOTS - 1, EE_TOTAL_SLOTS - 1 };
+static uint16_t lastSeq[EE_LOG_COUNT];
+
+static inline uint16_t slotAddr(EeLog log, uint8_t slot) {
+  return LOGS[log].base + (uint16_t)slot * LOGS[log].slotSize;
+}
+
+static inline uint8_t maxData(EeLog log) {
+  return LOGS[log].slotSize - HDR_SIZE;
+}
+
+static uint16_t readU16(uint16_t a) {
+  return (uint16_t)EEPROM.read(a) | ((uint16_t)EEPROM.read(a + 1) << 8);
+}
+
+// CRC по seq, len и данным (прямо из EEPROM или из RAM)
+static uint16_t slotCrc(uint16_t seq, uint8_t len, const uint8_t *ram, uint16_t eeData) {
+  uint16_t crc = 0xFFFF;
+  crc = _crc16_update(crc, (uint8_t)seq);
+  crc = _crc16_update(crc, (uint8_t)(seq >> 8));
+  crc = _crc16_update(crc, len);
+  for (uint8_t i = 0; i < len; i++) {
+    crc = _crc16_update(crc, ram ? ram[i] : EEPROM.read(eeData + i));
+  }
+  return crc;
+}
+
+static bool slotValid(EeLog log, uint8_t slot) {
+  uint16_t a = slotAddr(log, slot);
+  uint8_t len = EEPROM.read(a + 2);
+  if (len == 0 || len > maxData(log)) return false;
+  return slotCrc(readU16(a), len, nullptr, a + HDR_SIZE) == readU16(a + 3);
+}
+
+static volatile bool wBusy = false;
+
+bool eeStoreLoad(EeLog log, void *data, uint8_t maxLen, uint8_t &len) {
+  // Фоновая запись (например, settingsLoad() уже сохраняет умолчания)
+  // должна закончиться: между ожиданием EEPE в EEPROM.read() и EERE успеет
+  // ISR EE_READY, он начнёт следующий байт — и чтение вернёт мусор
+  while (wBusy) {}
+
+  // Самый новый seq (с учётом переполнения 16 бит): сначала только
+  // заголовки, CRC проверяется у кандидатов от новых к старым
+  const uint8_t slots = LOGS[log].slots;
+  bool used[EE_LOG_SLOTS];
+  uint8_t left = 0;
+  for (uint8_t i = 0; i < slots; i++) {
+    uint8_t l = EEPROM.read(slotAddr(log, i) + 2);
+    used[i] = (l != 0 && l <= maxData(log));
+    if (used[i]) left++;
+  }
+
+  while (left) {
+    uint8_t best = 0xFF;
+    uint16_t bestSeq = 0;
+    for (uint8_t i = 0; i < slots; i++) {
+      if (!used[i]) continue;
+      uint16_t seq = readU16(slotAddr(log, i));
+      if (best == 0xFF || (int16_t)(seq - bestSeq) > 0) { best = i; bestSeq = seq; }
+    }
+    used[best] = false;
+    left--;
+    if (!slotValid(log, best)) continue;   // оборванная запись (пропало питание)
+
+    uint16_t a = slotAddr(log, best);
+    len = EEPROM.read(a + 2);
+    uint8_t n = (len < maxLen) ? len : maxLen;
+    for (uint8_t i = 0; i < n; i++) ((uint8_t *)data)[i] = EEPROM.read(a + HDR_SIZE + i);
+
+    lastSlot[log] = best;
+    lastSeq[log] = bestSeq;
+    return true;
+  }
+
+  lastSlot[log] = slots - 1;
+  lastSeq[log] = 0;
+  return false;
+}
+
+// ===== Фоновая запись =====
+// Байт EEPROM пишется ~3.3 мс, запись слота целиком остановила бы loop() на
+// сотни мс. Поэтому запись копируется в буфер, а выдаёт её по байту ISR
+// EE_READY (срабатывает, когда EEPROM свободна). Одинаковые байты пропускаются.
+static uint8_t  wBuf[EE_LOG_SLOT_SIZE];
+static uint16_t wAddr = 0;                // адрес wBuf[0] в EEPROM
+static uint8_t  wLen = 0;
+static volatile uint8_t wPos = 0;
+
+// Порядок записи: сначала данные, потом len+crc, последним seq
+static inline uint8_t writeOffset(uint8_t i) {
+  uint8_t nData = wLen - HDR_SIZE;
+  if (i < nData) return HDR_SIZE + i;
+  i -= nData;
+  return (i < 3) ? (uint8_t)(2 + i) : (uint8_t)(i - 3);
+}
+
+static void writerStart(uint16_t addr, uint8_t len) {
+  wAddr = addr;
+  wLen = len;
+  wPos = 0;
+  wBusy = true;
+  EECR |= (1 << EERIE);
+}
+
+ISR(EE_READY_vect) {
+  while (wPos < wLen) {
+    uint8_t off = writeOffset(wPos++);
+    uint16_t a = wAddr + off;
+    uint8_t v = wBuf[off];
+
+    EEAR = a;
+    EECR |= (1 << EERE);
+    if (EEDR == v) continue;
+
+    EEDR = v;
+    EECR |= (1 << EEMPE);
+    EECR |= (1 << EEPE);   // не позже 4 тактов после EEMPE; прерывания уже запрещены
+    return;                // следующий байт — в следующем EE_READY
+  }
+
+  EECR &= ~(1 << EERIE);
+  wBusy = false;
+}
+
+bool eeStoreBusy() {
+  return wBusy;
+}
+
+bool eeStoreSave(EeLog log, const void *data, uint8_t len) {
+  if (wBusy) return false;
+  if (len > maxData(log)) len = maxData(log);
+
+  uint8_t slot = (uint8_t)(lastSlot[log] + 1);
+  if (slot >= LOGS[log].slots) slot = 0;
+  uint16_t seq = (uint16_t)(lastSeq[log] + 1);
+  const uint8_t *p = (const uint8_t *)data;
+  uint16_t crc = slotCrc(seq, len, p, 0);
+
+  wBuf[0] = (uint8_t)seq;
+  wBuf[1] = (uint8_t)(seq >> 8);
+  wBuf[2] = len;
+  wBuf[3] = (uint8_t)crc;
+  wBuf[4] = (uint8_t)(crc >> 8);
+  memcpy(wBuf + HDR_SIZE, p, len);
+
+  lastSlot[log] = slot;
+  lastSeq[log] = seq;
+  writerStart(slotAddr(log, slot), HDR_SIZE + len);
+  return true;
+}
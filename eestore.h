@@ -0,0 +1,22 @@
+#pragma once
+#include <Arduino.h>
+
+// Журналы записей в EEPROM с выравниванием износа.
+// У журнала свои слоты (config.h); каждое сохранение идёт в следующий слот
+// по кругу. Слот: seq (2) | len (1) | crc16 (2) | данные.
+// При загрузке берётся запись с самым новым seq и верным CRC.
+enum EeLog : uint8_t {
+  EE_LOG_SETTINGS,   // Settings: EE_LOG_SLOTS x EE_LOG_SLOT_SIZE с адреса 0
+  EE_LOG_TOTAL,      // общий счёт масла: EE_TOTAL_SLOTS x EE_TOTAL_SLOT_SIZE
+  EE_LOG_COUNT
+};
+
+// Запись не блокирует: данные копируются, а в EEPROM их по байту пишет
+// ISR EE_READY. Пока идёт запись (любого журнала), новая не принимается (false).
+
+// false — валидных записей нет (чистая EEPROM или старый формат).
+// Читать только при старте, до первой записи в этот журнал; начатую запись
+// (любого журнала) чтение сначала дожидается.
+bool eeStoreLoad(EeLog log, void *data, uint8_t maxLen, uint8_t &len);
+bool eeStoreSave(EeLog log, const void *data, uint8_t len);
+bool eeStoreBusy();
@@ -1,5 +1,7 @@
 #include "encoder_k040.h"
 #include "config.h"
+#include "input_queue.h"
+#include "prof.h"
 #include <Arduino.h>
 
 // ======= ENCODER (A=D2, B=D3) ISR decoder =======
@@ -12,19 +14,27 @@ static const int8_t kTrans[16] = {
   0, +1, -1,  0
 };
 
-static volatile int16_t isrEdges = 0;     // накопление "полушагов" (edges)
 static volatile uint8_t prevAB = 0;      // 2-битное предыдущее состояние
 static volatile uint32_t lastEdgeUs = 0; // защита от дребезга по времени
 
+static int8_t isrEdgeAcc = 0;             // переходы внутри текущего щелчка
+
+// Порты/маски A и B берутся из таблиц пинов ядра (UNO: D2=PD2, D3=PD3),
+// без жёстко прошитого PIND — так декодер работает с любым HAL/платой.
+static volatile uint8_t* encInA = nullptr;
+static volatile uint8_t* encInB = nullptr;
+static uint8_t encMaskA = 0;
+static uint8_t encMaskB = 0;
+
 static inline uint8_t readAB_fast() {
-  // UNO: D2=PD2, D3=PD3
-  uint8_t d = PIND;
-  uint8_t a = (d >> 2) & 1;
-  uint8_t b = (d >> 3) & 1;
+  uint8_t a = (*encInA & encMaskA) ? 1 : 0;
+  uint8_t b = (*encInB & encMaskB) ? 1 : 0;
   return (a << 1) | b;  // AB in bits: A as MSB, B as LSB
 }
 
 static void encISR() {
+  PROF_SCOPE(PROF_ISR_ENC);
+
   uint32_t us = micros();
   if ((uint16_t)(us - lastEdgeUs) < ENC_MIN_EDGE_US) return;
   lastEdgeUs = us;
@@ -34,133 +44,43 @@ static void encISR() {
   prevAB = ab;
 
   int8_t d = kTrans[idx];
-  if (d) isrEdges += d;
-}
-
-// ======= BUTTON (BTN=A3) debounce + click/hold =======
-static uint8_t pinBtn = A3;
-
-static bool     btnStable = true;     // HIGH = released
-static bool     btnLastRead = true;
-static uint32_t btnLastChangeMs = 0;
-static uint32_t btnPressMs = 0;
-static bool     holdFired = false;
-
-static void btnInit() {
-  pinMode(pinBtn, INPUT_PULLUP);
-  btnStable = digitalRead(pinBtn);
-  btnLastRead = btnStable;
-  btnLastChangeMs = millis();
-  btnPressMs = 0;
-  holdFired = false;
-}
+  if (!d) return;
 
-static void btnPoll(bool &click, bool &hold) {
-  click = false;
-  hold  = false;
+  isrEdgeAcc += d;
+  if (isrEdgeAcc < (int8_t)ENC_DETENT_EDGES && isrEdgeAcc > -(int8_t)ENC_DETENT_EDGES) return;
 
-  bool r = digitalRead(pinBtn); // HIGH released, LOW pressed
+  // 1 щелчок = ENC_DETENT_EDGES переходов
+  int8_t dir = (isrEdgeAcc > 0) ? 1 : -1;
+  isrEdgeAcc -= dir * (int8_t)ENC_DETENT_EDGES;
 
-  if (r != btnLastRead) {
-    btnLastRead = r;
-    btnLastChangeMs = millis();
-  }
-
-  // debounce
-  if ((uint32_t)(millis() - btnLastChangeMs) >= ENC_BTN_DEBOUNCE_MS) {
-    if (btnStable != btnLastRead) {
-      bool prev = btnStable;
-      btnStable = btnLastRead;
-
-      if (prev == HIGH && btnStable == LOW) {        // press
-        btnPressMs = millis();
-        holdFired = false;
-      } else if (prev == LOW && btnStable == HIGH) { // release
-        // short click if hold wasn't fired
-        if (!holdFired) click = true;
-        btnPressMs = 0;
-      }
-    }
-  }
-
-  // hold one-shot
-  if (btnStable == LOW && !holdFired) {
-    if ((uint32_t)(millis() - btnPressMs) >= ENC_BTN_LONG_MS) {
-      holdFired = true;
-      hold = true;
-    }
-  }
+  inputQueuePush(IEV_DETENT, ENC_INVERT_DIR ? -dir : dir);
 }
 
 // ======= EncoderK040 implementation =======
 static bool isrAttached = false;
 
-void EncoderK040::begin(uint8_t pinA, uint8_t pinB, uint8_t pinBtn_) {
-  (void)pinA;
-  (void)pinB;
-
-  pinBtn = pinBtn_;
+void EncoderK040::begin(uint8_t pinA, uint8_t pinB) {
+  _pinA = pinA;
+  _pinB = pinB;
 
   // Encoder pins
-  pinMode(PIN_BTN_UP, INPUT_PULLUP);    // D2
-  pinMode(PIN_BTN_DOWN, INPUT_PULLUP);  // D3
+  pinMode(_pinA, INPUT_PULLUP);    // D2
+  pinMode(_pinB, INPUT_PULLUP);    // D3
+
+  encInA = portInputRegister(digitalPinToPort(_pinA));
+  encInB = portInputRegister(digitalPinToPort(_pinB));
+  encMaskA = digitalPinToBitMask(_pinA);
+  encMaskB = digitalPinToBitMask(_pinB);
 
   // Init prev state
   prevAB = readAB_fast();
-  isrEdges = 0;
+  isrEdgeAcc = 0;
   lastEdgeUs = micros();
 
-  // Button init
-  btnInit();
-
   // Attach interrupts once
   if (!isrAttached) {
-    attachInterrupt(digitalPinToInterrupt(PIN_BTN_UP), encISR, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(PIN_BTN_DOWN), encISR, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(_pinA), encISR, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(_pinB), encISR, CHANGE);
     isrAttached = true;
   }
-
-  _inited = true;
-}
-
-EncoderEvents EncoderK040::poll() {
-  EncoderEvents ev;
-  if (!_inited) return ev;
-
-  // pull edges atomically
-  int16_t edges;
-  noInterrupts();
-  edges = isrEdges;
-  isrEdges = 0;
-  interrupts();
-
-  // Convert edges -> detents (1 щелчок = ENC_DETENT_EDGES переходов)
-  static int16_t edgeAcc = 0;
-  edgeAcc += edges;
-
-  static uint32_t lastStepMs = 0;
-  int8_t outStep = 0;
-
-  // выдаем максимум 1 шаг за poll(), остаток сохраняем
-  if (edgeAcc >= (int16_t)ENC_DETENT_EDGES) {
-    if ((uint32_t)(millis() - lastStepMs) >= ENC_STEP_GUARD_MS) {
-      outStep = +1;
-      edgeAcc -= ENC_DETENT_EDGES;
-      lastStepMs = millis();
-    }
-  } else if (edgeAcc <= -(int16_t)ENC_DETENT_EDGES) {
-    if ((uint32_t)(millis() - lastStepMs) >= ENC_STEP_GUARD_MS) {
-      outStep = -1;
-      edgeAcc += ENC_DETENT_EDGES;
-      lastStepMs = millis();
-    }
-  }
-
-  if (ENC_INVERT_DIR) outStep = -outStep;
-  ev.step = outStep;
-
-  // Button
-  btnPoll(ev.click, ev.hold);
-
-  return ev;
 }
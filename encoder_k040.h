@@ -1,19 +1,14 @@
 #pragma once
 #include <Arduino.h>
 
-struct EncoderEvents {
-  int8_t step = 0;      // +1 / -1 за один щелчок
-  bool   click = false; // короткое нажатие (OK)
-  bool   hold = false;  // длинное нажатие (MENU/BACK)
-};
-
+// Энкодер KY-040: декодер по прерываниям INT0/INT1. Каждый целый щелчок
+// кладётся в очередь ввода (input_queue) как IEV_DETENT с меткой времени.
+// Кнопка энкодера — в input_queue (общий антидребезг кнопок).
 class EncoderK040 {
 public:
-  // pinA = D2, pinB = D3 (для UNO это INT0/INT1), pinBtn = A3
-  void begin(uint8_t pinA, uint8_t pinB, uint8_t pinBtn);
-  EncoderEvents poll();
+  // pinA = D2, pinB = D3 (для UNO это INT0/INT1)
+  void begin(uint8_t pinA, uint8_t pinB);
 
 private:
   uint8_t _pinA = 0, _pinB = 0;
-  bool _inited = false;
 };
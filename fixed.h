@@ -0,0 +1,156 @@
+#pragma once
+#include <Arduino.h>
+
+// Число с фиксированной точкой: значение = raw / Scale.
+// Вместо ручных _x100/_x1000: масштаб — часть типа, смешать u/min x100 с
+// коэффициентом x100 без явного mul() или rescale() не выйдет.
+// Без 64-битной арифметики: произведение считается по частям (см. mul).
+// Делит только на константу Scale, но на AVR это всё равно 32-битное
+// библиотечное деление (__divmodsi4), обратной константы avr-gcc не
+// подставляет: mul — два деления на вызов, format — одно на число плюс одно
+// на каждые 4 цифры выше 65535.
+//
+//   Fixed<100> rec = Fixed<100>::fromRaw(55);                // 0.55
+//   Fixed<100> mn  = rec.mul(Fixed<100, uint16_t>::fromRaw(S.kmin_x100));
+//   char b[FIXED_FMT_BUF]; mn.format(b);                     // "0.27"
+//
+// Settings хранит сырые целые (раскладка EEPROM та же), Fixed — на месте
+// использования.
+
+// Буфер для format() под любой Fixed: самое длинное — Fixed<100, int32_t>
+// у INT32_MIN, "-21474836.48" и '\0' (проверяется в format)
+constexpr uint8_t FIXED_FMT_BUF = 13;
+
+template <uint16_t Scale, typename Storage = int32_t>
+struct Fixed {
+  static_assert(Scale >= 1, "Fixed: Scale must be positive");
+  static_assert(sizeof(Storage) <= 4, "Fixed: Storage wider than 32 bits defeats the purpose");
+
+  Storage raw;
+
+  static constexpr Fixed fromRaw(Storage r) { return Fixed{r}; }
+  static constexpr Fixed fromInt(Storage v) { return Fixed{(Storage)(v * (Storage)Scale)}; }
+
+  Storage whole() const { return raw / (Storage)Scale; }           // к нулю
+  Storage frac() const  { return raw % (Storage)Scale; }
+
+  // Смена масштаба: кратный вверх — умножение, вниз — деление (к нулю)
+  template <uint16_t S2, typename T2 = Storage>
+  Fixed<S2, T2> rescale() const {
+    static_assert(S2 % Scale == 0 || Scale % S2 == 0, "Fixed: scales must be multiples");
+    return Fixed<S2, T2>::fromRaw((S2 >= Scale) ? (T2)(raw * (T2)(S2 >= Scale ? S2 / Scale : 1))
+                                                : (T2)(raw / (Storage)(S2 >= Scale ? 1 : Scale / S2)));
+  }
+
+  // this * k, результат в масштабе this (к нулю, как (a * b) / S2).
+  // a * b / S = (a / S) * b + (a % S) * b / S: остаток меньше S, так что
+  // (a % S) * b влезает в int32 (S <= 10000, b 16 бит); переполниться может
+  // только первое слагаемое — когда не влезает и сам результат.
+  template <uint16_t S2, typename T2>
+  Fixed mul(Fixed<S2, T2> k) const {
+    static_assert(sizeof(T2) <= 2 || S2 == 1, "Fixed::mul: factor must be 16-bit (or integer)");
+    static_assert(S2 <= 10000, "Fixed::mul: (a % S) * b must fit in 31 bits");
+    Storage b = (Storage)k.raw;
+    Storage q = raw / (Storage)S2;
+    Storage r = raw % (Storage)S2;
+    return fromRaw((Storage)(q * b + (Storage)((int32_t)r * (int32_t)b / (int32_t)S2)));
+  }
+
+  Fixed operator+(Fixed o) const { return fromRaw((Storage)(raw + o.raw)); }
+  Fixed operator-(Fixed o) const { return fromRaw((Storage)(raw - o.raw)); }
+  Fixed &operator+=(Fixed o) { raw = (Storage)(raw + o.raw); return *this; }
+  Fixed &operator-=(Fixed o) { raw = (Storage)(raw - o.raw); return *this; }
+
+  bool operator==(Fixed o) const { return raw == o.raw; }
+  bool operator!=(Fixed o) const { return raw != o.raw; }
+  bool operator<(Fixed o) const  { return raw < o.raw; }
+  bool operator>(Fixed o) const  { return raw > o.raw; }
+  bool operator<=(Fixed o) const { return raw <= o.raw; }
+  bool operator>=(Fixed o) const { return raw >= o.raw; }
+
+  static constexpr uint8_t decimals() { return fixedDecimals(Scale); }
+
+  // "-12.34" без snprintf; dec — знаков после точки (лишние отбрасываются).
+  // out: FIXED_FMT_BUF байт. Возвращает длину.
+  uint8_t format(char *out, uint8_t dec = decimals()) const {
+    static_assert(fixedIsPow10(Scale), "Fixed::format: Scale must be a power of 10");
+    static_assert(fixedMaxLen() < FIXED_FMT_BUF, "Fixed::format: FIXED_FMT_BUF too small");
+    if (dec > decimals()) dec = decimals();
+    uint32_t a = (raw < 0) ? (uint32_t)0 - (uint32_t)raw : (uint32_t)raw;
+    uint32_t w = a / Scale;
+    uint16_t f = (uint16_t)(a - w * Scale);
+    for (uint8_t i = decimals(); i > dec; i--) f = fixedDiv10(f);
+
+    char *p = out;
+    if (raw < 0) *p++ = '-';
+    p += fixedUtoa(p, w);
+    if (dec) {
+      *p++ = '.';
+      for (uint8_t i = dec; i-- > 0;) {
+        uint16_t q = fixedDiv10(f);
+        p[i] = (char)('0' + (f - q * 10));
+        f = q;
+      }
+      p += dec;
+    }
+    *p = '\0';
+    return (uint8_t)(p - out);
+  }
+
+ private:
+  static constexpr bool fixedIsPow10(uint16_t s) {
+    return (s == 1) || (s % 10 == 0 && fixedIsPow10(s / 10));
+  }
+
+  static constexpr uint8_t fixedDecimals(uint16_t s) {
+    return (s >= 10) ? (uint8_t)(1 + fixedDecimals(s / 10)) : 0;
+  }
+
+  // Самое длинное из format(): знак, целая часть самого большого по модулю
+  // raw (для знакового — минимального), точка и дробь
+  static constexpr bool fixedSigned() { return (Storage)-1 < 0; }
+  static constexpr uint32_t fixedMaxAbs() {
+    return fixedSigned() ? (uint32_t)1 << (8 * sizeof(Storage) - 1)
+                         : (uint32_t)((Storage)~(Storage)0);
+  }
+  static constexpr uint8_t fixedDigits(uint32_t v) {
+    return (v >= 10) ? (uint8_t)(1 + fixedDigits(v / 10)) : 1;
+  }
+  static constexpr uint8_t fixedMaxLen() {
+    return (uint8_t)((fixedSigned() ? 1 : 0) + fixedDigits(fixedMaxAbs() / Scale) +
+                     (decimals() ? 1 + decimals() : 0));
+  }
+
+  // x / 10 для 16 бит через обратную константу (точно для 0..65535)
+  static uint16_t fixedDiv10(uint16_t x) {
+    return (uint16_t)(((uint32_t)x * 0xCCCDUL) >> 19);
+  }
+
+  static uint8_t fixedUtoa(char *out, uint32_t v) {
+    char t[10];
+    uint8_t n = 0;
+    while (v > 0xFFFFUL) {            // по 4 младших цифры на 32-битное деление
+      uint32_t q = v / 10000;
+      uint16_t r = (uint16_t)(v - q * 10000);
+      for (uint8_t i = 0; i < 4; i++) {
+        uint16_t rq = fixedDiv10(r);
+        t[n++] = (char)('0' + (uint8_t)(r - rq * 10));
+        r = rq;
+      }
+      v = q;
+    }
+    uint16_t s = (uint16_t)v;
+    do {
+      uint16_t q = fixedDiv10(s);
+      t[n++] = (char)('0' + (uint8_t)(s - q * 10));
+      s = q;
+    } while (s);
+    for (uint8_t i = 0; i < n; i++) out[i] = t[n - 1 - i];
+    return n;
+  }
+};
+
+// Единицы проекта
+using Fx100  = Fixed<100, int32_t>;    // u/min, мл, x100
+using Kx100  = Fixed<100, uint16_t>;   // коэффициенты настроек (kmin, kmax, al_factor, hyst)
+using Fx1000 = Fixed<1000, uint32_t>;  // ml_per_u, литры
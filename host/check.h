@@ -0,0 +1,30 @@
+#pragma once
+#include <stdio.h>
+
+// Проверки для тестов host/: провал печатается и считается, тест идёт
+// дальше; main() возвращает checkResult()
+static int checkFails = 0;
+
+#define CHECK(cond)                                                         \
+  do {                                                                      \
+    if (!(cond)) {                                                          \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      checkFails++;                                                         \
+    }                                                                       \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                      \
+  do {                                                                      \
+    long long va_ = (long long)(a), vb_ = (long long)(b);                   \
+    if (va_ != vb_) {                                                       \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",     \
+              __FILE__, __LINE__, #a, #b, va_, vb_);                        \
+      checkFails++;                                                         \
+    }                                                                       \
+  } while (0)
+
+static inline int checkResult(const char *name) {
+  if (checkFails) fprintf(stderr, "%s: %d check(s) failed\n", name, checkFails);
+  else printf("%s: ok\n", name);
+  return checkFails ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+// Ядро Arduino (UNO) для сборки прошивки на ПК: только то, чем пользуется
+// скетч. Пины, время и периферия — в модели host/sim.cpp.
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW  0
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+static const uint8_t SDA = A4;
+static const uint8_t SCL = A5;
+
+#define NOT_A_PORT 0
+#define PB 2
+#define PC 3
+#define PD 4
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t v);
+int digitalRead(uint8_t pin);
+
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+void attachInterrupt(uint8_t num, void (*fn)(void), int mode);
+
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t *portInputRegister(uint8_t port);
+volatile uint8_t *portOutputRegister(uint8_t port);
+volatile uint8_t *portModeRegister(uint8_t port);
+
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define B00000 0
+#define B00001 1
+#define B00100 4
+#define B00110 6
+#define B01010 10
+#define B01110 14
+#define B01111 15
+#define B10000 16
+#define B10001 17
+#define B10011 19
+#define B10101 21
+#define B11001 25
+#define B11111 31
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *b, size_t n) {
+    size_t r = 0;
+    while (n--) r += write(*b++);
+    return r;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printFmt("%d", v); }
+  size_t print(unsigned v) { return printFmt("%u", v); }
+  size_t print(long v) { return printFmt("%ld", v); }
+  size_t print(unsigned long v) { return printFmt("%lu", v); }
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { size_t r = print(v); return r + println(); }
+
+private:
+  template <typename T> size_t printFmt(const char *fmt, T v) {
+    char b[24];
+    snprintf(b, sizeof(b), fmt, v);
+    return write(b);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+};
+
+// Serial: вывод копится в simSerialOut(), ввод подкладывает simSerialIn()
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t b) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+};
+
+extern HardwareSerial Serial;
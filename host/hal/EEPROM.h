@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+#include <avr/eeprom.h>
+
+// Интерфейс EEPROM.h ядра Arduino поверх eeprom_read/update_byte
+struct EEPROMClass {
+  uint8_t read(int addr) { return eeprom_read_byte((const uint8_t *)(uintptr_t)addr); }
+  void write(int addr, uint8_t v) { eeprom_write_byte((uint8_t *)(uintptr_t)addr, v); }
+  void update(int addr, uint8_t v) { eeprom_update_byte((uint8_t *)(uintptr_t)addr, v); }
+  uint16_t length() { return E2END + 1; }
+
+  template <typename T> T &get(int addr, T &t) {
+    uint8_t *p = (uint8_t *)&t;
+    for (size_t i = 0; i < sizeof(T); i++) p[i] = read(addr + (int)i);
+    return t;
+  }
+  template <typename T> const T &put(int addr, const T &t) {
+    const uint8_t *p = (const uint8_t *)&t;
+    for (size_t i = 0; i < sizeof(T); i++) update(addr + (int)i, p[i]);
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
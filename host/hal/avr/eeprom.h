@@ -0,0 +1,9 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "io.h"
+
+// Как в avr-libc: через EEAR/EEDR/EECR, с ожиданием EEPE
+uint8_t eeprom_read_byte(const uint8_t *addr);
+void eeprom_write_byte(uint8_t *addr, uint8_t v);
+void eeprom_update_byte(uint8_t *addr, uint8_t v);
@@ -0,0 +1,9 @@
+#pragma once
+#include "io.h"
+
+// ISR — обычная функция с C-именем вектора: её вызывает модель
+// прерываний (host/sim.cpp), когда взведён флаг и разрешено SREG.I
+#define ISR(vector) extern "C" void vector(void)
+
+static inline void cli() { SREG &= (uint8_t)~_BV(SREG_I); }
+static inline void sei() { SREG |= (uint8_t)_BV(SREG_I); }
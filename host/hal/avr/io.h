@@ -0,0 +1,141 @@
+#pragma once
+#include <stdint.h>
+
+// Регистры ATmega328P для сборки на ПК (host/sim.cpp).
+// Большинство — просто память: их читает и пишет модель периферии между
+// инструкциями прошивки. Регистры, у которых запись или чтение что-то
+// делает (флаги "записать 1 = сбросить", запуск АЦП/TWI/EEPROM, SREG.I),
+// — объекты SimReg: каждое обращение уходит в модель.
+
+#define _BV(b) (1u << (b))
+
+enum SimRegId : uint8_t {
+  SIM_SREG,
+  SIM_TCCR1A,
+  SIM_TCCR1C,
+  SIM_TIFR0,
+  SIM_TIFR1,
+  SIM_TIFR2,
+  SIM_ADCSRA,
+  SIM_EECR,
+  SIM_TWCR,
+  SIM_REG_COUNT
+};
+
+uint8_t simRegRead(uint8_t id);
+void simRegWrite(uint8_t id, uint8_t v);
+
+template <uint8_t Id>
+struct SimReg {
+  operator uint8_t() const { return simRegRead(Id); }
+  SimReg &operator=(uint8_t v) { simRegWrite(Id, v); return *this; }
+  // как на AVR: чтение-модификация-запись (флаги, прочитанные как 1, сбросятся)
+  SimReg &operator|=(uint8_t v) { simRegWrite(Id, (uint8_t)(simRegRead(Id) | v)); return *this; }
+  SimReg &operator&=(uint8_t v) { simRegWrite(Id, (uint8_t)(simRegRead(Id) & v)); return *this; }
+  SimReg &operator^=(uint8_t v) { simRegWrite(Id, (uint8_t)(simRegRead(Id) ^ v)); return *this; }
+  SimReg &operator=(const SimReg &) = delete;
+};
+
+extern SimReg<SIM_SREG>   SREG;
+extern SimReg<SIM_TCCR1A> TCCR1A;
+extern SimReg<SIM_TCCR1C> TCCR1C;
+extern SimReg<SIM_TIFR0>  TIFR0;
+extern SimReg<SIM_TIFR1>  TIFR1;
+extern SimReg<SIM_TIFR2>  TIFR2;
+extern SimReg<SIM_ADCSRA> ADCSRA;
+extern SimReg<SIM_EECR>   EECR;
+extern SimReg<SIM_TWCR>   TWCR;
+
+extern volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0;
+extern volatile uint8_t TCCR1B, TIMSK1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2;
+extern volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+extern volatile uint8_t ADCSRB, ADMUX, DIDR0;
+extern volatile uint16_t ADC;
+extern volatile uint16_t EEAR;
+extern volatile uint8_t EEDR;
+extern volatile uint8_t TWBR, TWSR, TWDR, TWAR;
+extern volatile uint8_t EIMSK, EIFR, EICRA;
+
+#define SREG_I 7
+
+// Timer0
+#define TOV0   0
+#define OCF0A  1
+#define OCF0B  2
+#define TOIE0  0
+#define OCIE0A 1
+#define OCIE0B 2
+
+// Timer1
+#define WGM10  0
+#define WGM11  1
+#define COM1B0 4
+#define COM1B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define WGM12  3
+#define WGM13  4
+#define FOC1B  6
+#define FOC1A  7
+#define TOIE1  0
+#define OCIE1A 1
+#define OCIE1B 2
+#define TOV1   0
+#define OCF1A  1
+#define OCF1B  2
+
+// Timer2
+#define WGM20  0
+#define WGM21  1
+#define COM2A0 6
+#define COM2A1 7
+#define CS20   0
+#define CS21   1
+#define CS22   2
+#define OCIE2A 1
+#define OCF2A  1
+
+// ADC
+#define ADPS0  0
+#define ADPS1  1
+#define ADPS2  2
+#define ADIE   3
+#define ADIF   4
+#define ADATE  5
+#define ADSC   6
+#define ADEN   7
+#define ADTS0  0
+#define ADTS1  1
+#define ADTS2  2
+#define REFS0  6
+#define REFS1  7
+#define ADLAR  5
+
+// EEPROM
+#define EERE   0
+#define EEPE   1
+#define EEMPE  2
+#define EERIE  3
+
+// TWI
+#define TWIE   0
+#define TWEN   2
+#define TWWC   3
+#define TWSTO  4
+#define TWSTA  5
+#define TWEA   6
+#define TWINT  7
+#define TWPS0  0
+#define TWPS1  1
+
+#define INT0   0
+#define INT1   1
+
+#ifndef E2END
+#define E2END 0x3FF
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+// На ПК "flash" — та же память, *_P — обычные функции
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p)  (*(const uint8_t *)(p))
+#define pgm_read_word(p)  (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p)   (*(void *const *)(p))
+#define strcpy_P  strcpy
+#define strncpy_P strncpy
+#define strlen_P  strlen
+#define memcpy_P  memcpy
+#define snprintf_P snprintf
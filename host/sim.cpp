@@ -0,0 +1,700 @@
+#include <EEPROM.h>
+#include <string>
+#include "sim.h"
+
+// ===== Векторы прошивки =====
+// weak: тест линкует только нужные модули, чужих ISR может не быть
+extern "C" {
+void INT0_vect(void) __attribute__((weak));
+void INT1_vect(void) __attribute__((weak));
+void TIMER2_COMPA_vect(void) __attribute__((weak));
+void TIMER1_COMPA_vect(void) __attribute__((weak));
+void TIMER0_COMPA_vect(void) __attribute__((weak));
+void ADC_vect(void) __attribute__((weak));
+void EE_READY_vect(void) __attribute__((weak));
+void TWI_vect(void) __attribute__((weak));
+volatile unsigned long timer0_overflow_count = 0;   // wiring.c
+}
+
+// ===== Регистры =====
+SimReg<SIM_SREG>   SREG;
+SimReg<SIM_TCCR1A> TCCR1A;
+SimReg<SIM_TCCR1C> TCCR1C;
+SimReg<SIM_TIFR0>  TIFR0;
+SimReg<SIM_TIFR1>  TIFR1;
+SimReg<SIM_TIFR2>  TIFR2;
+SimReg<SIM_ADCSRA> ADCSRA;
+SimReg<SIM_EECR>   EECR;
+SimReg<SIM_TWCR>   TWCR;
+
+// Timer0 как после init() ядра: fast PWM, /64, TOIE0
+volatile uint8_t TCCR0A = 0x03, TCCR0B = 0x03, TCNT0, OCR0A, OCR0B, TIMSK0 = 0x01;
+volatile uint8_t TCCR1B, TIMSK1;
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2;
+volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+volatile uint8_t ADCSRB, ADMUX, DIDR0;
+volatile uint16_t ADC;
+volatile uint16_t EEAR;
+volatile uint8_t EEDR;
+volatile uint8_t TWBR, TWSR = 0xF8, TWDR, TWAR;
+volatile uint8_t EIMSK, EIFR, EICRA;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+static uint8_t reg[SIM_REG_COUNT] = { 0x80 };   // SREG.I: init() уже сделал sei()
+
+static uint64_t now = 0;
+static bool inIsr = false;
+static bool inAdvance = false;
+static constexpr uint64_t NEVER = ~0ULL;
+static constexpr uint8_t ACCESS_CYCLES = 2;     // обращение к регистру из main
+
+static void advanceTo(uint64_t end);
+static void deliver();
+
+static void fail(const char *msg) {
+  fprintf(stderr, "sim: %s (cycle %llu)\n", msg, (unsigned long long)now);
+  abort();
+}
+
+// Main-код обратился к регистру: прошло немного времени
+static void touch() {
+  if (!inIsr && !inAdvance) advanceTo(now + ACCESS_CYCLES);
+}
+
+uint64_t simCycles() { return now; }
+
+void simRun(uint64_t cycles) {
+  if (inIsr) return;   // delay() в ISR на железе тоже не ждёт прерываний
+  advanceTo(now + cycles);
+}
+
+unsigned long millis() { return (unsigned long)(now / SIM_CYCLES_PER_MS); }
+unsigned long micros() { return (unsigned long)(now / (F_CPU / 1000000UL)); }
+void delay(unsigned long ms) { simRun((uint64_t)ms * SIM_CYCLES_PER_MS); }
+void delayMicroseconds(unsigned int us) { simRun((uint64_t)us * (F_CPU / 1000000UL)); }
+
+// ===== Пины UNO: D0..7 = PD, D8..13 = PB, A0..A5 = PC =====
+static constexpr uint8_t PIN_COUNT = 20;
+static int8_t extLevel[PIN_COUNT];     // -1 = вход никто не тянет
+static bool extInit = false;
+static void (*intFn[2])(void);
+static uint8_t intFlag = 0;
+
+uint8_t digitalPinToPort(uint8_t pin) {
+  return (pin < 8) ? PD : (pin < 14) ? PB : (pin < PIN_COUNT) ? PC : NOT_A_PORT;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin) {
+  return (uint8_t)(1 << ((pin < 8) ? pin : (pin < 14) ? pin - 8 : pin - 14));
+}
+
+volatile uint8_t *portInputRegister(uint8_t port) {
+  return (port == PD) ? &PIND : (port == PB) ? &PINB : &PINC;
+}
+
+volatile uint8_t *portOutputRegister(uint8_t port) {
+  return (port == PD) ? &PORTD : (port == PB) ? &PORTB : &PORTC;
+}
+
+volatile uint8_t *portModeRegister(uint8_t port) {
+  return (port == PD) ? &DDRD : (port == PB) ? &DDRB : &DDRC;
+}
+
+static uint8_t oc1aLatch = 0;
+static uint8_t stepLevel = 0;
+static uint64_t stepRising = 0;
+void (*simOnStep)(uint64_t cycle, uint8_t level) = nullptr;
+
+static uint8_t pinLevelNow(uint8_t pin) {
+  uint8_t port = digitalPinToPort(pin), m = digitalPinToBitMask(pin);
+  if (pin == 9 && (reg[SIM_TCCR1A] & (_BV(COM1A1) | _BV(COM1A0)))) return oc1aLatch;
+  if (*portModeRegister(port) & m) return (*portOutputRegister(port) & m) ? 1 : 0;
+  if (extLevel[pin] >= 0) return (uint8_t)extLevel[pin];
+  return (*portOutputRegister(port) & m) ? 1 : 0;   // подтяжка
+}
+
+// Пересчитать PINx; перепады на D2/D3 взводят INT0/INT1, на D9 — счёт STEP
+static void pinsUpdate() {
+  if (!extInit) {
+    for (uint8_t i = 0; i < PIN_COUNT; i++) extLevel[i] = -1;
+    extInit = true;
+  }
+  uint8_t old2 = (PIND >> 2) & 1, old3 = (PIND >> 3) & 1;
+  uint8_t pb = 0, pc = 0, pd = 0;
+  for (uint8_t i = 0; i < PIN_COUNT; i++) {
+    if (!pinLevelNow(i)) continue;
+    uint8_t port = digitalPinToPort(i), m = digitalPinToBitMask(i);
+    if (port == PD) pd |= m; else if (port == PB) pb |= m; else pc |= m;
+  }
+  PINB = pb; PINC = pc; PIND = pd;
+
+  if (intFn[0] && ((pd >> 2) & 1) != old2) intFlag |= 1;
+  if (intFn[1] && ((pd >> 3) & 1) != old3) intFlag |= 2;
+
+  uint8_t s = (pb >> 1) & 1;
+  if (s != stepLevel) {
+    stepLevel = s;
+    if (s) stepRising++;
+    if (simOnStep) simOnStep(now, s);
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  uint8_t port = digitalPinToPort(pin), m = digitalPinToBitMask(pin);
+  if (port == NOT_A_PORT) return;
+  if (mode == OUTPUT) *portModeRegister(port) |= m;
+  else {
+    *portModeRegister(port) &= (uint8_t)~m;
+    if (mode == INPUT_PULLUP) *portOutputRegister(port) |= m;
+    else                      *portOutputRegister(port) &= (uint8_t)~m;
+  }
+  pinsUpdate();
+}
+
+void digitalWrite(uint8_t pin, uint8_t v) {
+  uint8_t port = digitalPinToPort(pin), m = digitalPinToBitMask(pin);
+  if (port == NOT_A_PORT) return;
+  if (v) *portOutputRegister(port) |= m;
+  else   *portOutputRegister(port) &= (uint8_t)~m;
+  pinsUpdate();
+}
+
+int digitalRead(uint8_t pin) {
+  pinsUpdate();
+  return pinLevelNow(pin);
+}
+
+void attachInterrupt(uint8_t num, void (*fn)(void), int mode) {
+  if (num > 1 || mode != CHANGE) fail("attachInterrupt: only INT0/INT1 on CHANGE are modelled");
+  intFn[num] = fn;
+  pinsUpdate();
+  intFlag &= (uint8_t)~(1 << num);
+}
+
+void simPinDrive(uint8_t pin, uint8_t level) {
+  pinsUpdate();
+  extLevel[pin] = level ? 1 : 0;
+  pinsUpdate();
+  deliver();
+}
+
+void simPinRelease(uint8_t pin) {
+  pinsUpdate();
+  extLevel[pin] = -1;
+  pinsUpdate();
+  deliver();
+}
+
+uint8_t simPinLevel(uint8_t pin) {
+  pinsUpdate();
+  return pinLevelNow(pin);
+}
+
+uint64_t simStepRising() { return stepRising; }
+
+// ===== Timer1 / Timer2: CTC =====
+static uint16_t presc1() {
+  static const uint16_t p[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+  return p[TCCR1B & 7];
+}
+
+static uint16_t presc2() {
+  static const uint16_t p[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+  return p[TCCR2B & 7];
+}
+
+// Тиков прескалера p в (from, to]
+static uint64_t ticksIn(uint64_t from, uint64_t to, uint16_t p) {
+  return to / p - from / p;
+}
+
+// Такт совпадения: счётчик дошёл до OCR, следующий тик сбрасывает его в 0
+static uint64_t ctcNext(uint32_t cnt, uint32_t top, uint32_t max, uint16_t p) {
+  if (!p) return NEVER;
+  uint64_t m = (cnt <= top) ? (top - cnt + 1) : (max + 1 - cnt + top + 1);
+  return (now / p + m) * p;
+}
+
+static void oc1aAction(uint8_t com) {
+  if (com == 1) oc1aLatch ^= 1;
+  else if (com == 2) oc1aLatch = 0;
+  else if (com == 3) oc1aLatch = 1;
+}
+
+// ===== Timer0: /64 от сброса, TCNT0 и счёт переполнений — от времени =====
+static void timer0Sync() {
+  uint64_t k = now / 64;
+  TCNT0 = (uint8_t)k;
+  timer0_overflow_count = (unsigned long)(k >> 8);
+}
+
+static uint64_t t0Next(uint8_t at) {
+  uint64_t k = now / 64 + 1;
+  k += (uint8_t)(at - (uint8_t)k);
+  return k * 64;
+}
+
+// ===== АЦП =====
+static uint16_t adcIn[8];
+static bool adcBusy = false;
+static bool adcFirst = true;
+static uint64_t adcDoneAt = NEVER;
+
+void simAdcSet(uint8_t ch, uint16_t v) {
+  adcIn[ch & 7] = (v > 1023) ? 1023 : v;
+}
+
+static void adcStart() {
+  static const uint8_t div[8] = { 2, 2, 4, 8, 16, 32, 64, 128 };
+  adcBusy = true;
+  reg[SIM_ADCSRA] |= _BV(ADSC);
+  adcDoneAt = now + (uint64_t)(adcFirst ? 25 : 13) * div[reg[SIM_ADCSRA] & 7];
+  adcFirst = false;
+}
+
+static bool adcTriggerOnTov0() {
+  uint8_t a = reg[SIM_ADCSRA];
+  return (a & _BV(ADEN)) && (a & _BV(ADATE)) && (ADCSRB & 7) == 4;
+}
+
+// ===== EEPROM: 3.4 мс на байт =====
+static constexpr uint32_t EE_WRITE_CYCLES = 54400;
+static uint8_t eeMem[E2END + 1];
+static uint32_t eeWear[E2END + 1];
+static bool eeMemInit = false;
+static bool eePowerOn = true;
+static uint64_t eeDoneAt = NEVER;
+static uint16_t eeWAddr;
+static uint8_t eeWData;
+static uint64_t eempeAt = 0;
+
+uint8_t *simEeprom() {
+  if (!eeMemInit) { memset(eeMem, 0xFF, sizeof(eeMem)); eeMemInit = true; }
+  return eeMem;
+}
+
+uint32_t simEeWrites(uint16_t addr) { return eeWear[addr & E2END]; }
+
+void simEePower(bool on) {
+  if (!on && eeDoneAt != NEVER) {
+    simEeprom()[eeWAddr] = 0xFF;   // стирание прошло, запись — нет
+    eeWear[eeWAddr]++;
+  }
+  eePowerOn = on;
+}
+
+static void eeDone() {
+  eeDoneAt = NEVER;
+  if (eePowerOn) {
+    simEeprom()[eeWAddr] = eeWData;
+    eeWear[eeWAddr]++;
+  }
+  reg[SIM_EECR] &= (uint8_t)~_BV(EEPE);
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+  while (EECR & _BV(EEPE)) {}
+  EEAR = (uint16_t)(uintptr_t)addr;
+  EECR |= _BV(EERE);
+  return EEDR;
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t v) {
+  while (EECR & _BV(EEPE)) {}
+  EEAR = (uint16_t)(uintptr_t)addr;
+  EEDR = v;
+  uint8_t sreg = SREG;
+  cli();
+  EECR |= _BV(EEMPE);
+  EECR |= _BV(EEPE);
+  SREG = sreg;
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t v) {
+  if (eeprom_read_byte(addr) != v) eeprom_write_byte(addr, v);
+}
+
+// ===== TWI + PCF8574 + HD44780 =====
+static constexpr uint8_t PCF_ADDR = 0x27;
+static constexpr uint8_t PCF_RS = 0x01, PCF_EN = 0x04;
+enum TwiPhase : uint8_t { TWI_IDLE, TWI_SLA, TWI_DATA };
+static TwiPhase twiPhase = TWI_IDLE;
+static bool twiOwnBus = false;
+static bool twiAcked = false;   // адрес PCF принят
+static uint64_t twiDoneAt = NEVER;
+static uint64_t twiStopAt = NEVER;
+static uint8_t twiNextSr = 0xF8;
+static uint8_t twiNackLeft = 0;
+static uint8_t twiArbLose = 0;  // 1 — на следующем SLA, 2 — на следующем байте данных
+
+void simTwiNack(uint8_t n) { twiNackLeft = n; }
+void simTwiLoseArbitration(bool inData) { twiArbLose = inData ? 2 : 1; }
+
+static uint32_t twiBitCycles() {
+  static const uint8_t p4[4] = { 1, 4, 16, 64 };
+  return 16UL + 2UL * TWBR * p4[TWSR & 3];
+}
+
+// другой мастер перебил: байт до PCF не дошёл, шина не наша
+static bool twiArbLost(uint8_t phase) {
+  if (twiArbLose != phase) return false;
+  twiArbLose = 0;
+  twiNextSr = 0x38;
+  twiPhase = TWI_IDLE;
+  twiOwnBus = false;
+  twiDoneAt = now + 9 * twiBitCycles();
+  return true;
+}
+
+// HD44780: после сброса 8-битный интерфейс, function set 0x2x — в 4 бита
+static uint8_t pcfOut = 0;
+static bool lcd4bit = false;
+static bool lcdHaveHi = false;
+static uint8_t lcdHi = 0;
+static uint8_t lcdDdram[0x80];
+static bool lcdDdramInit = false;
+static uint8_t lcdCgram[64];
+static uint8_t lcdAc = 0;
+static bool lcdCg = false;
+static uint64_t lcdBusyUntil = 0;
+static SimLcdStats lcdStats;
+
+const SimLcdStats &simLcdStats() { return lcdStats; }
+void simLcdResetStats() { memset(&lcdStats, 0, sizeof(lcdStats)); }
+
+static void lcdExec(uint8_t b, bool rs) {
+  if (!lcdDdramInit) { memset(lcdDdram, ' ', sizeof(lcdDdram)); lcdDdramInit = true; }
+  if (now < lcdBusyUntil) lcdStats.busyViolations++;
+  uint32_t execCycles = 37 * 16;
+
+  if (rs) {
+    lcdStats.data++;
+    if (lcdCg) { lcdCgram[lcdAc & 63] = b; lcdAc = (uint8_t)((lcdAc + 1) & 63); }
+    else {
+      lcdDdram[lcdAc & 0x7F] = b;
+      lcdAc = (lcdAc == 0x27) ? 0x40 : (lcdAc == 0x67) ? 0x00 : (uint8_t)(lcdAc + 1);
+    }
+  } else {
+    lcdStats.commands++;
+    if (b == 0x01) {
+      memset(lcdDdram, ' ', sizeof(lcdDdram));
+      lcdAc = 0; lcdCg = false; lcdStats.clears++; execCycles = 1520 * 16;
+    } else if ((b & 0xFE) == 0x02) {
+      lcdAc = 0; lcdCg = false; lcdStats.clears++; execCycles = 1520 * 16;
+    } else if (b & 0x80) {
+      lcdAc = b & 0x7F; lcdCg = false;
+    } else if (b & 0x40) {
+      lcdAc = b & 0x3F; lcdCg = true;
+    } else if ((b & 0xE0) == 0x20) {
+      lcd4bit = !(b & 0x10);
+    }
+  }
+  lcdBusyUntil = now + execCycles;
+}
+
+static void pcfWrite(uint8_t v) {
+  lcdStats.pcfBytes++;
+  bool fall = (pcfOut & PCF_EN) && !(v & PCF_EN);
+  pcfOut = v;
+  if (!fall) return;
+
+  uint8_t nib = v >> 4;
+  bool rs = v & PCF_RS;
+  if (!lcd4bit) {
+    lcdExec((uint8_t)(nib << 4), rs);
+    lcdHaveHi = false;
+  } else if (!lcdHaveHi) {
+    lcdHi = nib;
+    lcdHaveHi = true;
+  } else {
+    lcdHaveHi = false;
+    lcdExec((uint8_t)((lcdHi << 4) | nib), rs);
+  }
+}
+
+void simLcdRow(uint8_t row, char out[21]) {
+  static const uint8_t offs[4] = { 0x00, 0x40, 0x14, 0x54 };
+  if (!lcdDdramInit) { memset(lcdDdram, ' ', sizeof(lcdDdram)); lcdDdramInit = true; }
+  for (uint8_t i = 0; i < 20; i++) out[i] = (char)lcdDdram[offs[row & 3] + i];
+  out[20] = '\0';
+}
+
+static void twiDone() {
+  twiDoneAt = NEVER;
+  TWSR = (uint8_t)((TWSR & 3) | twiNextSr);
+  reg[SIM_TWCR] |= _BV(TWINT);
+}
+
+static void twiWrite(uint8_t v) {
+  uint8_t old = reg[SIM_TWCR];
+  uint8_t keep = (v & _BV(TWINT)) ? 0 : (old & _BV(TWINT));   // TWINT: запись 1 сбрасывает
+  reg[SIM_TWCR] = (uint8_t)((v & ~_BV(TWINT) & ~_BV(TWWC)) | keep);
+
+  if (!(v & _BV(TWEN))) {
+    twiPhase = TWI_IDLE; twiOwnBus = false; twiDoneAt = twiStopAt = NEVER;
+    reg[SIM_TWCR] &= (uint8_t)~(_BV(TWSTO) | _BV(TWSTA));
+    return;
+  }
+  if (!(v & _BV(TWINT))) return;   // без сброса TWINT шина не трогается
+
+  uint32_t bit = twiBitCycles();
+  if (v & _BV(TWSTO)) {
+    twiPhase = TWI_IDLE;
+    twiOwnBus = false;
+    twiStopAt = now + bit;
+  } else if (v & _BV(TWSTA)) {
+    twiNextSr = twiOwnBus ? 0x10 : 0x08;
+    twiOwnBus = true;
+    twiPhase = TWI_SLA;
+    twiDoneAt = now + bit;
+  } else if (twiPhase == TWI_SLA) {
+    if (twiArbLost(1)) return;
+    twiAcked = (TWDR >> 1) == PCF_ADDR && !(TWDR & 1);
+    twiNextSr = twiAcked ? 0x18 : 0x20;
+    twiPhase = TWI_DATA;
+    twiDoneAt = now + 9 * bit;
+  } else if (twiPhase == TWI_DATA) {
+    if (twiArbLost(2)) return;
+    bool ack = twiAcked && twiNackLeft == 0;
+    if (twiNackLeft) twiNackLeft--;
+    if (ack) pcfWrite(TWDR);
+    twiNextSr = ack ? 0x28 : 0x30;
+    twiDoneAt = now + 9 * bit;
+  } else {
+    fail("TWI: data write without START");
+  }
+}
+
+// ===== Свой источник прерывания =====
+static uint32_t irqPeriod = 0;
+static void (*irqFn)() = nullptr;
+static uint64_t irqAt = NEVER;
+static bool irqFlag = false;
+
+void simIrqEvery(uint32_t periodCycles, void (*fn)()) {
+  irqPeriod = periodCycles;
+  irqFn = fn;
+  irqAt = periodCycles ? now + periodCycles : NEVER;
+}
+
+// ===== Регистры с поведением =====
+uint8_t simRegRead(uint8_t id) {
+  switch (id) {
+    case SIM_TCCR1C:
+      return 0;   // FOC — только запись
+    case SIM_EECR:
+      touch();
+      if (reg[SIM_EECR] & _BV(EEMPE) && now > eempeAt + 4) reg[SIM_EECR] &= (uint8_t)~_BV(EEMPE);
+      return reg[SIM_EECR];
+    case SIM_SREG:
+    case SIM_ADCSRA:
+    case SIM_TWCR:
+      touch();
+      return reg[id];
+    default:
+      return (id < SIM_REG_COUNT) ? reg[id] : 0;
+  }
+}
+
+void simRegWrite(uint8_t id, uint8_t v) {
+  switch (id) {
+    case SIM_SREG: {
+      uint8_t old = reg[SIM_SREG];
+      reg[SIM_SREG] = v;
+      if (!(old & _BV(SREG_I)) && (v & _BV(SREG_I))) deliver();
+      return;
+    }
+
+    case SIM_TCCR1A:
+      reg[id] = v;
+      pinsUpdate();
+      return;
+
+    case SIM_TCCR1C:
+      if (v & _BV(FOC1A)) {
+        oc1aAction((reg[SIM_TCCR1A] >> COM1A0) & 3);
+        pinsUpdate();
+      }
+      return;
+
+    case SIM_TIFR0:
+    case SIM_TIFR1:
+    case SIM_TIFR2:
+      reg[id] &= (uint8_t)~v;   // запись 1 сбрасывает флаг
+      return;
+
+    case SIM_ADCSRA: {
+      uint8_t flag = (v & _BV(ADIF)) ? 0 : (reg[id] & _BV(ADIF));
+      reg[id] = (uint8_t)((v & ~_BV(ADIF) & ~_BV(ADSC)) | flag | (reg[id] & _BV(ADSC)));
+      if (!(v & _BV(ADEN))) {
+        adcBusy = false; adcDoneAt = NEVER; adcFirst = true;
+        reg[id] &= (uint8_t)~_BV(ADSC);
+      } else if ((v & _BV(ADSC)) && !adcBusy) {
+        adcStart();
+      }
+      deliver();
+      return;
+    }
+
+    case SIM_EECR: {
+      bool busy = eeDoneAt != NEVER;
+      uint8_t keep = reg[id] & (_BV(EEPE) | _BV(EEMPE));
+      reg[id] = (uint8_t)((v & _BV(EERIE)) | keep);
+      if ((v & _BV(EEMPE)) && !(keep & _BV(EEMPE))) { reg[id] |= _BV(EEMPE); eempeAt = now; }
+      if ((v & _BV(EERE)) && !busy) EEDR = simEeprom()[EEAR & E2END];
+      if ((v & _BV(EEPE)) && !busy && (reg[id] & _BV(EEMPE)) && now <= eempeAt + 4) {
+        eeWAddr = EEAR & E2END;
+        eeWData = EEDR;
+        eeDoneAt = now + EE_WRITE_CYCLES;
+        reg[id] = (uint8_t)((reg[id] | _BV(EEPE)) & ~_BV(EEMPE));
+      }
+      deliver();
+      return;
+    }
+
+    case SIM_TWCR:
+      twiWrite(v);
+      deliver();
+      return;
+
+    default:
+      fail("write to unknown register");
+  }
+}
+
+// ===== Прерывания =====
+// Порядок — номера векторов ATmega328P (меньше = важнее)
+enum Vec : uint8_t { V_INT0, V_INT1, V_T2A, V_T1A, V_T0A, V_ADC, V_EE, V_TWI, V_SIM, V_NONE };
+
+static Vec pendingVec() {
+  if (intFlag & 1) return V_INT0;
+  if (intFlag & 2) return V_INT1;
+  if ((TIMSK2 & _BV(OCIE2A)) && (reg[SIM_TIFR2] & _BV(OCF2A))) return V_T2A;
+  if ((TIMSK1 & _BV(OCIE1A)) && (reg[SIM_TIFR1] & _BV(OCF1A))) return V_T1A;
+  if ((TIMSK0 & _BV(OCIE0A)) && (reg[SIM_TIFR0] & _BV(OCF0A))) return V_T0A;
+  uint8_t a = reg[SIM_ADCSRA];
+  if ((a & _BV(ADIE)) && (a & _BV(ADIF))) return V_ADC;
+  uint8_t e = reg[SIM_EECR];
+  if ((e & _BV(EERIE)) && !(e & _BV(EEPE))) return V_EE;
+  uint8_t t = reg[SIM_TWCR];
+  if ((t & _BV(TWIE)) && (t & _BV(TWINT)) && (t & _BV(TWEN))) return V_TWI;
+  if (irqFlag) return V_SIM;
+  return V_NONE;
+}
+
+static void runIsr(void (*fn)(void), const char *name) {
+  if (!fn) {
+    fprintf(stderr, "sim: interrupt %s enabled without ISR\n", name);
+    abort();
+  }
+  reg[SIM_SREG] &= (uint8_t)~_BV(SREG_I);
+  inIsr = true;
+  fn();
+  inIsr = false;
+  reg[SIM_SREG] |= _BV(SREG_I);   // reti
+}
+
+static void deliver() {
+  if (inIsr || !(reg[SIM_SREG] & _BV(SREG_I))) return;
+  for (uint32_t guard = 0;; guard++) {
+    if (guard > 100000) fail("interrupt storm: a flag is never cleared");
+    switch (pendingVec()) {
+      case V_INT0: intFlag &= (uint8_t)~1; runIsr(intFn[0], "INT0"); break;
+      case V_INT1: intFlag &= (uint8_t)~2; runIsr(intFn[1], "INT1"); break;
+      case V_T2A: reg[SIM_TIFR2] &= (uint8_t)~_BV(OCF2A); runIsr(TIMER2_COMPA_vect, "TIMER2_COMPA"); break;
+      case V_T1A: reg[SIM_TIFR1] &= (uint8_t)~_BV(OCF1A); runIsr(TIMER1_COMPA_vect, "TIMER1_COMPA"); break;
+      case V_T0A: reg[SIM_TIFR0] &= (uint8_t)~_BV(OCF0A); runIsr(TIMER0_COMPA_vect, "TIMER0_COMPA"); break;
+      case V_ADC: reg[SIM_ADCSRA] &= (uint8_t)~_BV(ADIF); runIsr(ADC_vect, "ADC"); break;
+      case V_EE: runIsr(EE_READY_vect, "EE_READY"); break;       // по уровню
+      case V_TWI: runIsr(TWI_vect, "TWI"); break;                // TWINT сбрасывает сама ISR
+      case V_SIM: irqFlag = false; runIsr(irqFn, "sim"); break;
+      default: return;
+    }
+  }
+}
+
+// ===== Ход времени: от события к событию =====
+static void advanceTo(uint64_t end) {
+  inAdvance = true;
+  while (now < end) {
+    uint16_t p1 = presc1(), p2 = presc2();
+    uint64_t e1 = ctcNext(TCNT1, OCR1A, 0xFFFF, p1);
+    uint64_t e2 = ctcNext(TCNT2, OCR2A, 0xFF, p2);
+    uint64_t e0a = (TIMSK0 & _BV(OCIE0A)) ? t0Next(OCR0A) : NEVER;
+    uint64_t e0v = adcTriggerOnTov0() ? t0Next(0) : NEVER;
+
+    uint64_t t = end;
+    const uint64_t ev[] = { e1, e2, e0a, e0v, adcDoneAt, eeDoneAt, twiDoneAt, twiStopAt, irqAt };
+    for (uint64_t e : ev) if (e < t) t = e;
+
+    // счётчики до t; совпадение в t — отдельно
+    if (p1) {
+      uint64_t n = ticksIn(now, t, p1);
+      TCNT1 = (uint16_t)(TCNT1 + n - (e1 == t ? 1 : 0));
+    }
+    if (p2) {
+      uint64_t n = ticksIn(now, t, p2);
+      TCNT2 = (uint8_t)(TCNT2 + n - (e2 == t ? 1 : 0));
+    }
+    now = t;
+    timer0Sync();
+
+    if (e2 == t) {
+      TCNT2 = 0;
+      reg[SIM_TIFR2] |= _BV(OCF2A);
+    }
+    if (e1 == t) {
+      TCNT1 = 0;
+      reg[SIM_TIFR1] |= _BV(OCF1A);
+      oc1aAction((reg[SIM_TCCR1A] >> COM1A0) & 3);
+      pinsUpdate();
+    }
+    if (e0a == t) reg[SIM_TIFR0] |= _BV(OCF0A);
+    if (e0v == t && !adcBusy) adcStart();
+    if (adcDoneAt == t) {
+      adcDoneAt = NEVER;
+      adcBusy = false;
+      ADC = adcIn[ADMUX & 7];
+      reg[SIM_ADCSRA] = (uint8_t)((reg[SIM_ADCSRA] & ~_BV(ADSC)) | _BV(ADIF));
+    }
+    if (eeDoneAt == t) eeDone();
+    if (twiDoneAt == t) twiDone();
+    if (twiStopAt == t) {
+      twiStopAt = NEVER;
+      reg[SIM_TWCR] &= (uint8_t)~_BV(TWSTO);
+    }
+    if (irqAt == t) {
+      irqFlag = true;
+      irqAt = now + irqPeriod;
+    }
+
+    inAdvance = false;
+    deliver();
+    inAdvance = true;
+  }
+  inAdvance = false;
+}
+
+// ===== Serial =====
+static std::string serialOut, serialIn;
+
+size_t HardwareSerial::write(uint8_t b) {
+  serialOut += (char)b;
+  return 1;
+}
+
+int HardwareSerial::available() { return (int)serialIn.size(); }
+
+int HardwareSerial::read() {
+  if (serialIn.empty()) return -1;
+  int c = (uint8_t)serialIn[0];
+  serialIn.erase(0, 1);
+  return c;
+}
+
+const char *simSerialOut() { return serialOut.c_str(); }
+void simSerialClear() { serialOut.clear(); }
+void simSerialIn(const char *s) { serialIn += s; }
@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+
+// Модель ATmega328P для сборки прошивки на ПК (host/).
+// Виртуальные такты CPU: время идёт только в simRun()/delay() и когда
+// main-код опрашивает регистр (каждое обращение к SimReg — пара тактов),
+// поэтому занятые ожидания вида while (TWCR ...) работают как на железе.
+// Прерывания — по флагам и разрешениям, с приоритетами векторов AVR и
+// только при SREG.I; ISR не вложены.
+//
+// Что моделируется:
+//  - Timer0 (millis, COMPA, TOV0 как запуск АЦП), Timer1 CTC с OC1A
+//    (toggle/clear/set, FOC1A), Timer2 CTC;
+//  - АЦП с автозапуском, EEPROM (3.4 мс на байт, EE_READY, счёт износа),
+//    TWI-мастер и на шине PCF8574 -> HD44780 2004 (4 бита, занятость);
+//  - пины UNO (подтяжки, внешний уровень), INT0/INT1 по CHANGE, Serial.
+
+// ===== Время =====
+constexpr uint32_t SIM_CYCLES_PER_MS = F_CPU / 1000UL;
+
+uint64_t simCycles();
+void simRun(uint64_t cycles);             // main стоит, периферия и ISR идут
+inline void simRunMs(uint32_t ms) { simRun((uint64_t)ms * SIM_CYCLES_PER_MS); }
+
+// Свой источник прерывания (самый младший приоритет): fn вызывается как ISR
+// каждые periodCycles тактов; 0 — выключить
+void simIrqEvery(uint32_t periodCycles, void (*fn)());
+
+// ===== Пины =====
+void simPinDrive(uint8_t pin, uint8_t level);   // внешний уровень на входе
+void simPinRelease(uint8_t pin);                // отпущен: подтяжка/0
+uint8_t simPinLevel(uint8_t pin);
+
+// STEP (OC1A, D9): счёт фронтов и обратный вызов на каждый перепад
+uint64_t simStepRising();
+extern void (*simOnStep)(uint64_t cycle, uint8_t level);
+
+// ===== АЦП =====
+void simAdcSet(uint8_t ch, uint16_t v);         // 0..1023
+
+// ===== EEPROM =====
+uint8_t *simEeprom();                           // E2END + 1 байт
+uint32_t simEeWrites(uint16_t addr);            // циклов стирания/записи ячейки
+void simEePower(bool on);                       // off: текущий байт рвётся в 0xFF, дальше не пишется
+
+// ===== I2C LCD =====
+struct SimLcdStats {
+  uint32_t commands;        // инструкции HD44780 (RS = 0)
+  uint32_t clears;          // из них clear/home
+  uint32_t data;            // байты данных (RS = 1)
+  uint32_t busyViolations;  // инструкция пришла, пока контроллер занят
+  uint32_t pcfBytes;        // байты, принятые PCF8574
+};
+const SimLcdStats &simLcdStats();
+void simLcdResetStats();
+void simLcdRow(uint8_t row, char out[21]);      // DDRAM строки 2004 как текст
+void simTwiNack(uint8_t n);                     // следующие n байт данных — NACK
+void simTwiLoseArbitration(bool inData);        // следующий SLA (или байт данных) — потеря арбитража
+
+// ===== Serial =====
+const char *simSerialOut();
+void simSerialClear();
+void simSerialIn(const char *s);
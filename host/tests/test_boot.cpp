@@ -0,0 +1,25 @@
+// Прошивка целиком: setup() на чистой EEPROM, пара секунд loop(), READY на LCD
+#include "sim.h"
+#include "check.h"
+#include "mql_2004_I2C_encoder_V2.ino"
+
+int main() {
+  simAdcSet(PIN_POT - A0, 512);
+  setup();
+  for (uint32_t i = 0; i < 20000; i++) {
+    loop();
+    simRun(1600);   // ~100 мкс на проход loop()
+  }
+
+  char row[21];
+  bool any = false;
+  for (uint8_t r = 0; r < 4; r++) {
+    simLcdRow(r, row);
+    printf("|%s|\n", row);
+    if (strspn(row, " ") != 20) any = true;
+  }
+  CHECK(any);
+  CHECK_EQ(simLcdStats().busyViolations, 0);
+  CHECK_EQ(state, ST_READY);
+  return checkResult("test_boot");
+}
@@ -0,0 +1,25 @@
+// setup(): settingsLoad() на чистой EEPROM сразу запускает
+// фоновую запись умолчаний — общий счёт масла, прочитанный после неё,
+// не должен прийти из EEPROM, занятой записью
+#include "sim.h"
+#include "check.h"
+#include "mql_2004_I2C_encoder_V2.ino"
+#include "eestore.h"
+
+int main() {
+  const uint32_t total = 987654;
+  eeStoreSave(EE_LOG_TOTAL, &total, sizeof(total));
+  while (eeStoreBusy()) simRunMs(1);
+
+  simAdcSet(PIN_POT - A0, 512);
+  setup();
+  CHECK_EQ(totalizerLifetimeMl_x100(), total);
+
+  for (uint32_t i = 0; i < 5000; i++) {
+    loop();
+    simRun(1600);
+  }
+  CHECK(!settingsSavePending());
+  CHECK_EQ(state, ST_READY);
+  return checkResult("test_boot_ee");
+}
@@ -0,0 +1,87 @@
+// DDS: заданная частота в mHz против выданных шагов на D9 по
+// всему ходу потенциометра и на краях диапазона частот.
+//  - средний период STEP по N шагам против F_CPU * 1000 / mHz;
+//  - pumpGetStepCount() за 2 с против mHz * 2 / 1000 (на быстрых частотах
+//    счёт идёт тиком Timer2 и отстаёт до 1 мс шагов), после стопа — против
+//    фронтов.
+#include <math.h>
+#include "sim.h"
+#include "check.h"
+#include "config.h"
+#include "pump.h"
+
+static uint64_t rises = 0;
+static uint64_t riseLast = 0;   // такт фронта номер riseStop
+static uint64_t riseFirst = 0;
+static uint64_t riseStop = 0;
+
+static void onStep(uint64_t cycle, uint8_t level) {
+  if (!level) return;
+  if (rises == 0) riseFirst = cycle;
+  if (rises == riseStop) riseLast = cycle;
+  rises++;
+}
+
+static void runRate(uint32_t flow_x100, uint32_t gain) {
+  uint64_t want_mHz = ((uint64_t)flow_x100 * gain + 3) / 6;
+
+  pumpSetEnable(true);
+  uint32_t c0 = pumpGetStepCount();
+  uint64_t r0 = simStepRising();
+  pumpRunCont((int32_t)flow_x100, gain);
+  simRunMs(2000);
+  uint32_t got = pumpGetStepCount() - c0;
+
+  // период: от первого фронта после 2 с до фронта через N шагов
+  uint64_t n = want_mHz / 500 + 20;              // ~2 с, не меньше 20 шагов
+  rises = 0;
+  riseStop = n;
+  simOnStep = onStep;
+  while (rises <= n) simRun(64);
+  simOnStep = nullptr;
+  uint64_t t0 = riseFirst, t1 = riseLast;
+  pumpStopNow();
+  simRunMs(5);
+  uint32_t total = pumpGetStepCount() - c0;
+  uint64_t edges = simStepRising() - r0;
+
+  double ideal = (double)F_CPU * 1000.0 / (double)want_mHz;   // тактов на шаг
+  double meas = (double)(t1 - t0) / (double)n;
+  double err = (meas - ideal) / ideal;
+
+  // дробь DDS до PUMP_DDS_MAX_CMP_HZ фронтов, выше — 0.5 тика прескалера 1
+  double tol = (want_mHz * 2 < PUMP_DDS_MAX_CMP_HZ * 1000ULL) ? 1e-4 : 0.5 * 2 / ideal + 64.0 / (ideal * n);
+  double expect = want_mHz * 2.0;                // шагов за 2 с, mHz -> шаги
+  double lag = want_mHz / 1e6;                   // шагов за мс тика Timer2
+
+  printf("  flow %5u gain %6u: %10.3f Hz  period err %+.5f%%  steps %u / %.0f  total %u (edges %llu)\n",
+         (unsigned)flow_x100, (unsigned)gain, want_mHz / 1000.0, err * 100, got, expect / 1000.0,
+         total, (unsigned long long)edges);
+  CHECK(fabs(err) <= tol);
+  CHECK(fabs(got - expect / 1000.0) <= 2 + lag + expect / 1000.0 * tol);
+  CHECK(llabs((long long)total - (long long)edges) <= 1);
+}
+
+int main() {
+  pumpBegin();
+  pumpSetRamp(0, 0);
+
+  // ход POT: rec 0.55 u/min, kmin 0.50 .. kmax 2.00, АЦП 0..4092
+  const uint32_t gains[] = { 1000, 6400, 51200, 400000 };
+  for (uint32_t g : gains) {
+    for (uint16_t adc = 0; adc <= 4092; adc += 511) {
+      uint32_t flow = 27 + (uint32_t)(110 - 27) * adc / 4092;
+      runRate(flow, g);
+    }
+  }
+
+  // края: у самой медленной частоты Timer1 (0.12 шаг/с) и до PUMP_MAX_STEP_HZ,
+  // где шаги считает тик Timer2, а период — целые тики без дроби
+  runRate(1, 720);
+  runRate(1, 4000);
+  runRate(9000, 600);
+  runRate(9000, 20000);
+  runRate(9000, 66000);
+
+  return checkResult("test_dds");
+}
@@ -0,0 +1,140 @@
+// Fixed<Scale, Storage> против прежней арифметики на int64 и
+// snprintf:
+//  - raw -> format -> разбор строки -> тот же raw (туда и обратно), длина
+//    меньше FIXED_FMT_BUF, и у INT32_MIN тоже;
+//  - whole/frac: raw == whole * Scale + frac, к нулю;
+//  - mul == (int64)a * k / S2, rescale == умножение/деление на кратное;
+//  - format с меньшим числом знаков отбрасывает лишние, как раньше.
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "fixed.h"
+
+static uint32_t rng = 7;
+static uint32_t rnd32() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+// знак, целая часть, дробь -> raw (как прочитал бы человек с экрана)
+static long long parseRaw(const char *s, long long scale, uint8_t dec) {
+  bool neg = (*s == '-');
+  if (neg) s++;
+  char *end;
+  long long v = strtoll(s, &end, 10) * scale;
+  if (*end == '.') {
+    long long f = 0, m = scale;
+    for (uint8_t i = 0; i < dec; i++) { f = f * 10 + (end[1 + i] - '0'); m /= 10; }
+    v += f * m;
+  }
+  return neg ? -v : v;
+}
+
+template <uint16_t S, typename T>
+static uint32_t roundTrip(T raw) {
+  typedef Fixed<S, T> F;
+  F x = F::fromRaw(raw);
+  uint32_t bad = 0;
+
+  char b[FIXED_FMT_BUF + 4];
+  memset(b, '#', sizeof(b));
+  uint8_t n = x.format(b);
+  if (n != strlen(b) || n >= FIXED_FMT_BUF || b[FIXED_FMT_BUF] != '#') bad++;
+  if (parseRaw(b, S, F::decimals()) != (long long)raw) bad++;
+
+  // прежний вывод: snprintf целой части и дроби
+  char ref[24];
+  long long a = (raw < 0) ? -(long long)raw : (long long)raw;
+  if (F::decimals()) {
+    snprintf(ref, sizeof(ref), "%s%lld.%0*lld", raw < 0 ? "-" : "", a / S, F::decimals(), a % S);
+  } else {
+    snprintf(ref, sizeof(ref), "%lld", (long long)raw);
+  }
+  if (strcmp(b, ref) != 0) bad++;
+
+  // меньше знаков: хвост просто отрезан
+  if (F::decimals() > 1) {
+    char c[FIXED_FMT_BUF];
+    x.format(c, 1);
+    size_t cut = strlen(ref) - (F::decimals() - 1);
+    if (strlen(c) != cut || strncmp(c, ref, cut) != 0) bad++;
+  }
+
+  if ((long long)x.whole() * S + x.frac() != (long long)raw) bad++;
+  if ((long long)x.whole() != (long long)raw / S) bad++;
+  if (bad) fprintf(stderr, "  raw %lld: \"%s\" (want \"%s\")\n", (long long)raw, b, ref);
+  return bad;
+}
+
+template <uint16_t S, typename T>
+static uint32_t sweep(const char *name) {
+  uint32_t bad = 0;
+  const T lo = ((T)-1 < 0) ? (T)((T)1 << (8 * sizeof(T) - 1)) : (T)0;
+  const T hi = (T)~lo;
+  const T edges[] = { lo, (T)(lo + 1), hi, (T)(hi - 1), (T)0, (T)1, (T)(S - 1), (T)S, (T)(S + 1) };
+  for (T e : edges) bad += roundTrip<S, T>(e);
+  if ((T)-1 < 0) {
+    const T neg[] = { (T)-1, (T)(-(T)S + 1), (T)-(T)S, (T)(-(T)S - 1) };
+    for (T e : neg) bad += roundTrip<S, T>(e);
+  }
+  for (int i = 0; i < 200000; i++) {
+    T r = (T)rnd32();
+    if (i & 1) r = (T)(r >> (rnd32() % (8 * sizeof(T))));   // и короткие числа
+    bad += roundTrip<S, T>(r);
+  }
+  printf("  %s: %u mismatches\n", name, (unsigned)bad);
+  return bad;
+}
+
+int main() {
+  // ===== туда и обратно, длина буфера =====
+  CHECK_EQ((sweep<100, int32_t>("Fx100")), 0u);
+  CHECK_EQ((sweep<100, uint16_t>("Kx100")), 0u);
+  CHECK_EQ((sweep<1000, uint32_t>("Fx1000")), 0u);
+  CHECK_EQ((sweep<10000, int32_t>("Fixed<10000>")), 0u);
+  CHECK_EQ((sweep<1, uint32_t>("Fixed<1, uint32_t>")), 0u);
+  CHECK_EQ((sweep<10, int16_t>("Fixed<10, int16_t>")), 0u);
+
+  char b[FIXED_FMT_BUF];
+  CHECK_EQ(Fx100::fromRaw(INT32_MIN).format(b), FIXED_FMT_BUF - 1);
+  CHECK(strcmp(b, "-21474836.48") == 0);
+
+  // ===== mul против (int64)a * k / S2 =====
+  uint32_t badMul = 0;
+  for (int i = 0; i < 1000000; i++) {
+    // результат должен влезать в int32, как у вызывающих (rec * k)
+    int32_t a = (int32_t)rnd32() >> (rnd32() % 16 + 8);
+    uint16_t k = (uint16_t)rnd32();
+    int64_t want = (int64_t)a * k / 100;
+    if (want > INT32_MAX || want < INT32_MIN) continue;
+    if (Fx100::fromRaw(a).mul(Kx100::fromRaw(k)).raw != want) badMul++;
+    int64_t want1000 = (int64_t)a * (k % 10001) / 10000;
+    if (Fx100::fromRaw(a).mul(Fixed<10000, uint16_t>::fromRaw(k % 10001)).raw != want1000) badMul++;
+  }
+  CHECK_EQ(badMul, 0u);
+  CHECK_EQ(Fx100::fromRaw(55).mul(Kx100::fromRaw(50)).raw, 27);   // 0.55 * 0.50
+
+  // ===== rescale =====
+  uint32_t badRescale = 0;
+  for (int i = 0; i < 100000; i++) {
+    int32_t a = (int32_t)rnd32() >> 4;
+    if (Fx100::fromRaw(a).rescale<1>().raw != a / 100) badRescale++;
+    if (Fx100::fromRaw(a).rescale<10>().raw != a / 10) badRescale++;
+    if (Fx100::fromRaw(a).rescale<1000>().raw != a * 10) badRescale++;
+    uint32_t u = rnd32();
+    if ((Fixed<100, uint32_t>::fromRaw(u).rescale<1>().raw) != u / 100) badRescale++;
+  }
+  CHECK_EQ(badRescale, 0u);
+  // мл x100 -> литры x1000 (пункт меню "масло всего")
+  Fx1000::fromRaw(Fixed<100, uint32_t>::fromRaw(123456789UL).rescale<1>().raw).format(b);
+  CHECK(strcmp(b, "1234.567") == 0);
+
+  CHECK_EQ(Fx100::fromInt(-3).raw, -300);
+  CHECK((Fx100::fromRaw(150) + Fx100::fromRaw(-200)) == Fx100::fromRaw(-50));
+  Fx100::fromRaw(-50).format(b);
+  CHECK(strcmp(b, "-0.50") == 0);
+
+  return checkResult("test_fixed");
+}
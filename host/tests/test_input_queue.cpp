@@ -0,0 +1,129 @@
+// Очередь ввода ISR -> loop() под пачками прерываний.
+// Свой источник прерывания пишет события с порядковым номером (в arg),
+// кнопка START параллельно даёт настоящие события из Timer0, а loop()
+// то успевает, то надолго занят (кадр LCD, запись EEPROM).
+//  - порядок строго по номерам, без повторов и порчи полей;
+//  - пока пачка влезает в очередь, ничего не теряется;
+//  - при переполнении теряются только новые события, и ровно столько,
+//    сколько насчитал inputQueueDropped();
+//  - нажатия START приходят парами DOWN/UP, сколько их было.
+#include "sim.h"
+#include "check.h"
+#include "config.h"
+#include "input_queue.h"
+
+static uint32_t pushed = 0;          // номер следующего события
+static uint8_t  burst = 0;           // событий на одно прерывание
+
+static void burstIsr() {
+  for (uint8_t i = 0; i < burst; i++) {
+    inputQueuePush(IEV_DETENT, (int8_t)(pushed & 0x7F));
+    pushed++;
+  }
+}
+
+static uint32_t popped = 0, lost = 0, badOrder = 0, badField = 0;
+static uint32_t btnDown = 0, btnUp = 0;
+static uint16_t lastMs = 0;
+
+static void drain() {
+  InputEv e;
+  while (inputQueuePop(e)) {
+    if ((uint16_t)(e.ms - lastMs) > 1000) badField++;   // метки не назад
+    lastMs = e.ms;
+    if (e.type == IEV_DETENT) {
+      // пропуск номеров — только потерянные при переполнении
+      uint32_t want = popped + lost;
+      uint8_t gap = (uint8_t)(((uint8_t)e.arg - want) & 0x7F);
+      if (gap) lost += gap;
+      popped++;
+      if (e.arg < 0) badOrder++;
+    } else if (e.type == IEV_BTN_DOWN && e.arg == BTN_START) {
+      if (btnDown != btnUp) badOrder++;
+      btnDown++;
+    } else if (e.type == IEV_BTN_UP && e.arg == BTN_START) {
+      btnUp++;
+      if (btnDown != btnUp) badOrder++;
+    } else {
+      badField++;
+    }
+  }
+}
+
+// loop(): опрос каждые pollUs, раз в busyEveryMs — занят busyMs
+static void phase(uint32_t ms, uint32_t pollUs, uint32_t busyEveryMs, uint32_t busyMs) {
+  uint64_t end = simCycles() + (uint64_t)ms * SIM_CYCLES_PER_MS;
+  uint64_t nextBusy = simCycles() + (uint64_t)busyEveryMs * SIM_CYCLES_PER_MS;
+  while (simCycles() < end) {
+    drain();
+    if (busyEveryMs && simCycles() >= nextBusy) {
+      simRunMs(busyMs);
+      nextBusy += (uint64_t)busyEveryMs * SIM_CYCLES_PER_MS;
+    } else {
+      simRun((uint64_t)pollUs * 16);
+    }
+  }
+  drain();
+}
+
+static void pressStart(uint32_t ms) {
+  simPinDrive(PIN_START_BTN, 0);
+  phase(ms, 100, 0, 0);
+  simPinRelease(PIN_START_BTN);
+  phase(60, 100, 0, 0);
+}
+
+int main() {
+  inputQueueBegin(PIN_BTN_OK, PIN_START_BTN);
+  simRunMs(50);
+
+  // ===== ровный поток, loop() успевает =====
+  burst = 1;
+  simIrqEvery(200 * 16, burstIsr);                 // раз в 200 мкс
+  phase(500, 100, 0, 0);
+  CHECK_EQ(inputQueueDropped(), 0);
+  CHECK_EQ(lost, 0u);
+
+  // ===== пачки, которые влезают: 24 события раз в 10 мс, loop() занят 8 мс =====
+  burst = 24;
+  simIrqEvery(10 * SIM_CYCLES_PER_MS, burstIsr);
+  for (uint8_t i = 0; i < 5; i++) {
+    simPinDrive(PIN_START_BTN, 0);
+    phase(120, 100, 10, 8);
+    simPinRelease(PIN_START_BTN);
+    phase(120, 100, 10, 8);
+  }
+  printf("  bursts: %u pushed, %u popped, %u dropped\n",
+         (unsigned)pushed, (unsigned)popped, (unsigned)inputQueueDropped());
+  CHECK_EQ(inputQueueDropped(), 0);
+  CHECK_EQ(lost, 0u);
+  CHECK_EQ(btnDown, 5u);
+  CHECK_EQ(btnUp, 5u);
+
+  // ===== переполнение: loop() один раз занят 25 мс (EEPROM), пачки не ждут =====
+  // (потерь меньше 128 — номер в arg семибитный; счётчик потерь до 255)
+  simIrqEvery(0, nullptr);
+  phase(20, 100, 0, 0);
+  uint8_t dropped0 = inputQueueDropped();
+  burst = 24;
+  simIrqEvery(5 * SIM_CYCLES_PER_MS, burstIsr);
+  phase(30, 100, 20, 25);
+  burst = 1;                                       // поток после пропуска виден по номерам
+  simIrqEvery(200 * 16, burstIsr);
+  phase(20, 100, 0, 0);
+  simIrqEvery(0, nullptr);
+  phase(20, 100, 0, 0);
+  pressStart(100);                                 // после переполнения кнопка жива
+  uint32_t dropped = (uint8_t)(inputQueueDropped() - dropped0);
+  printf("  overflow: %u pushed, %u popped, %u lost, %u dropped\n",
+         (unsigned)pushed, (unsigned)popped, (unsigned)lost, (unsigned)dropped);
+  CHECK(dropped > 0);
+  CHECK_EQ(lost, dropped);
+  CHECK_EQ(popped + lost, pushed);
+  CHECK_EQ(btnDown, 6u);
+  CHECK_EQ(btnUp, 6u);
+
+  CHECK_EQ(badOrder, 0u);
+  CHECK_EQ(badField, 0u);
+  return checkResult("test_input_queue");
+}
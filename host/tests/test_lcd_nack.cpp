@@ -0,0 +1,68 @@
+// LCD по TWI: NACK посреди кадра не должен вешать очередь —
+// busy() перезапускает передачу, следующий текст доходит до экрана.
+// Потеря арбитража: на SLA байт данных ещё не уходил — повторять нечего,
+// на байте данных он уходит заново; PCF получает столько же байт, что и
+// без потери.
+#include <string.h>
+#include "sim.h"
+#include "check.h"
+#include "config.h"
+#include "lcd_async.h"
+
+static LcdAsync lcd(LCD_I2C_ADDR, 20, 4);
+
+// как uiRedrawDue(): loop() только спрашивает busy()
+static bool drain(uint32_t ms) {
+  for (uint32_t i = 0; i < ms * 10; i++) {
+    if (!lcd.busy()) return true;
+    simRun(SIM_CYCLES_PER_MS / 10);
+  }
+  return false;
+}
+
+int main() {
+  lcd.init();
+  lcd.backlight();
+
+  char row[21];
+  for (uint8_t n = 1; n <= 20; n++) {
+    lcd.setCursor(0, 0);
+    lcd.print("HELLO, WORLD");
+    simRun(SIM_CYCLES_PER_MS / 4);   // передача уже идёт
+    simTwiNack(n);                   // n байт подряд без ACK
+    CHECK(drain(50));
+
+    lcd.setCursor(0, 1);
+    lcd.print("LINE ");
+    lcd.print((unsigned)n);
+    lcd.print("   ");
+    CHECK(drain(50));
+    simLcdRow(1, row);
+    char want[21];
+    snprintf(want, sizeof(want), "LINE %-3u", (unsigned)n);
+    CHECK(strncmp(row, want, strlen(want)) == 0);
+  }
+  // ===== потеря арбитража =====
+  static const char *const arb[3] = { "ARB NONE", "ARB SLA ", "ARB DATA" };
+  uint32_t pcf[3];
+  for (uint8_t k = 0; k < 3; k++) {
+    uint32_t p0 = simLcdStats().pcfBytes;
+    if (k == 1) simTwiLoseArbitration(false);   // первый же SLA кадра
+    lcd.setCursor(0, 2);
+    lcd.print(arb[k]);
+    if (k == 2) {
+      simRun(SIM_CYCLES_PER_MS / 4);
+      simTwiLoseArbitration(true);              // посреди байта HD44780
+    }
+    CHECK(drain(50));
+    pcf[k] = simLcdStats().pcfBytes - p0;
+    simLcdRow(2, row);
+    CHECK(strncmp(row, arb[k], strlen(arb[k])) == 0);
+  }
+  printf("  PCF bytes: %u, arbitration lost on SLA %u, on data %u\n",
+         (unsigned)pcf[0], (unsigned)pcf[1], (unsigned)pcf[2]);
+  CHECK_EQ(pcf[1], pcf[0]);
+  CHECK_EQ(pcf[2], pcf[0]);
+
+  return checkResult("test_lcd_nack");
+}
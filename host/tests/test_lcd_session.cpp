@@ -0,0 +1,124 @@
+// Экраны без lcd.clear(): сценарий с энкодером и кнопками —
+// READY -> MENU (весь список вниз и вверх, правка с отменой, язык туда и
+// обратно) -> READY -> RUN -> READY. Считает инструкции HD44780 за сеанс:
+// ни одного clear/home после init(), без нарушений занятости; счётчики
+// uiGetLcdBytesTotal/uiGetLcdCmdTotal сходятся с принятым HD44780, кадр
+// не больше LCD_LOOP_BUDGET байт; в конце экран READY совпадает с тем, что
+// был после загрузки (переходы поверх теневого буфера не оставляют хвостов).
+#include "sim.h"
+#include "check.h"
+#include "mql_2004_I2C_encoder_V2.ino"
+
+static uint16_t maxFrame = 0;   // байт LCD за кадр, максимум за сеанс
+
+static void run(uint32_t ms) {
+  for (uint32_t i = 0; i < ms * 10; i++) {
+    loop();
+    if (uiGetLastFrameBytes() > maxFrame) maxFrame = uiGetLastFrameBytes();
+    simRun(1600);   // ~100 мкс на проход loop()
+  }
+}
+
+// Щелчки KY-040: 4 перехода Грея, 1 мс между ними (> ENC_MIN_EDGE_US).
+// clicks > 0 — по меню вниз (с ENC_INVERT_DIR это обратный порядок Грея)
+static void turn(int8_t clicks) {
+  static const uint8_t fwd[4] = { 0x1, 0x0, 0x2, 0x3 };   // AB: 11 -> 01 -> 00 -> 10 -> 11
+  for (int8_t c = 0; c < (clicks < 0 ? -clicks : clicks); c++) {
+    for (uint8_t i = 0; i < 4; i++) {
+      uint8_t ab = fwd[(clicks > 0) ? 3 - ((i + 1) & 3) : i];
+      simPinDrive(PIN_BTN_UP, (ab >> 1) & 1);
+      simPinDrive(PIN_BTN_DOWN, ab & 1);
+      run(1);
+    }
+    run(150);       // медленно: без ускорения
+  }
+}
+
+static void press(uint8_t pin, uint32_t ms) {
+  simPinDrive(pin, 0);
+  run(ms);
+  simPinRelease(pin);
+  run(150);
+}
+
+static void screen(char rows[4][21]) {
+  run(300);         // кадр дорисован
+  for (uint8_t r = 0; r < 4; r++) simLcdRow(r, rows[r]);
+}
+
+int main() {
+  simAdcSet(PIN_POT - A0, 512);
+  simPinDrive(PIN_BTN_UP, 1);
+  simPinDrive(PIN_BTN_DOWN, 1);
+  setup();
+  char ready[4][21], now[4][21];
+  screen(ready);
+  CHECK_EQ(state, ST_READY);
+
+  simLcdResetStats();
+  uint32_t bytes0 = uiGetLcdBytesTotal(), cmds0 = uiGetLcdCmdTotal();
+  maxFrame = 0;
+  uint32_t steps = 0;
+
+  press(PIN_BTN_OK, 100);                    // READY -> MENU
+  CHECK_EQ(state, ST_MENU);
+  steps++;
+
+  turn(MI_COUNT - 1);                        // весь список вниз
+  CHECK_EQ(menu.index, MI_COUNT - 1);
+  turn(-(int8_t)(MI_COUNT - 1));             // и вверх
+  CHECK_EQ(menu.index, 0);
+  steps += 2 * (MI_COUNT - 1);
+
+  Material mat = S.material;
+  press(PIN_BTN_OK, 100);                    // правка материала
+  CHECK(menu.editing);
+  turn(1);
+  CHECK(S.material != mat);
+  press(PIN_BTN_OK, 900);                    // удержание: отмена
+  CHECK(!menu.editing);
+  CHECK_EQ(S.material, mat);
+  steps += 3;
+
+  UiLang lang = S.uiLang;
+  turn(MI_LANGUAGE);
+  for (uint8_t k = 0; k < 2; k++) {          // язык туда и обратно
+    press(PIN_BTN_OK, 100);
+    turn(1);
+    press(PIN_BTN_OK, 100);
+    CHECK(S.uiLang != lang || k == 1);
+    steps += 3;
+  }
+  CHECK_EQ(S.uiLang, lang);
+  turn(-(int8_t)MI_LANGUAGE);
+  steps += 2 * MI_LANGUAGE;
+
+  press(PIN_START_BTN, 100);                 // MENU -> READY
+  CHECK_EQ(state, ST_READY);
+  press(PIN_START_BTN, 100);                 // READY -> RUN
+  CHECK_EQ(state, ST_RUN);
+  run(1000);
+  press(PIN_START_BTN, 100);                 // RUN -> READY
+  CHECK_EQ(state, ST_READY);
+  steps += 3;
+  run(1000);                                 // торможение, общий счёт
+
+  screen(now);
+  const SimLcdStats &st = simLcdStats();
+  printf("  %u UI steps: %u HD44780 commands (%u clear/home), %u data bytes, %u PCF bytes\n",
+         (unsigned)steps, (unsigned)st.commands, (unsigned)st.clears, (unsigned)st.data, (unsigned)st.pcfBytes);
+  CHECK_EQ(st.clears, 0);
+  CHECK_EQ(st.busyViolations, 0);
+  // счётчики ui.cpp сходятся с тем, что принял HD44780, и кадр в бюджете
+  printf("  ui counters: %u bytes, %u commands, max %u bytes/frame\n",
+         (unsigned)(uiGetLcdBytesTotal() - bytes0), (unsigned)(uiGetLcdCmdTotal() - cmds0), (unsigned)maxFrame);
+  CHECK_EQ(uiGetLcdBytesTotal() - bytes0, st.commands + st.data);
+  CHECK_EQ(uiGetLcdCmdTotal() - cmds0, st.commands);
+  CHECK(maxFrame > 0);
+  CHECK(maxFrame <= LCD_LOOP_BUDGET);
+  for (uint8_t r = 0; r < 4; r++) {
+    printf("  |%s|  |%s|\n", ready[r], now[r]);
+    CHECK(strcmp(ready[r], now[r]) == 0);
+  }
+  return checkResult("test_lcd_session");
+}
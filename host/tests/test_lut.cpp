@@ -0,0 +1,90 @@
+// Таблица POT -> частота против прямого расчёта
+// mHz = (flowMin * adcMax + span * adc) * gain / (6 * adcMax), как делал
+// pumpRunCont, на всех значениях АЦП 0..POT_ADC_MAX:
+//  - частота совпадает с прямой до округления (+-2 mHz), и за
+//    PUMP_MAX_STEP_HZ тоже (зажимает вызывающий);
+//  - период STEP (Q6 тактов) — в пределах 0.2% от периода для выданной
+//    частоты, зажатой в пределы Timer1: и у нижнего края, где узел 0 ниже
+//    минимума, и на отрезке через PUMP_MAX_STEP_HZ;
+//  - таблица перестраивается при смене эпохи (и через 256 правок тоже),
+//    но не при той же эпохе.
+#include <math.h>
+#include "check.h"
+#include "config.h"
+#include "pot.h"
+#include "pump.h"
+
+static const double EDGES = PUMP_STEP_HW ? 2 : 1;
+static const double MIN_MHZ = ceil((double)F_CPU * 1000.0 / (67108864.0 * EDGES));
+
+static double directMHz(int32_t mn, int32_t mx, uint32_t gain, uint16_t adc) {
+  double m = ((double)mn * POT_ADC_MAX + (double)(mx - mn) * adc) * gain / (6.0 * POT_ADC_MAX);
+  return (m < 0) ? 0 : floor(m + 0.5);
+}
+
+// период для частоты, зажатой в пределы Timer1
+static double periodQOf(double mHz) {
+  if (mHz < MIN_MHZ) mHz = MIN_MHZ;
+  if (mHz > PUMP_MAX_STEP_HZ * 1000.0) mHz = PUMP_MAX_STEP_HZ * 1000.0;
+  return (double)F_CPU * 1000.0 * 64.0 / (mHz * EDGES);
+}
+
+struct Range {
+  int32_t mn, mx;
+  uint32_t gain;
+};
+
+static uint16_t epoch = 0;
+
+static void sweep(const Range &r) {
+  pumpLutSync(++epoch, r.mn, r.mx, r.gain, POT_ADC_MAX);
+
+  double maxRate = 0, maxPer = 0;
+  uint32_t badRate = 0, badPer = 0;
+  for (uint16_t adc = 0; adc <= POT_ADC_MAX; adc++) {
+    uint32_t periodQ = 0;
+    uint32_t got = pumpLutRate_mHz(adc, &periodQ);
+    double want = directMHz(r.mn, r.mx, r.gain, adc);
+
+    double eRate = fabs((double)got - want);
+    if (eRate > maxRate) maxRate = eRate;
+    if (eRate > 2) badRate++;
+    if (got == 0) continue;   // стоп, период не нужен
+
+    double wantP = periodQOf(got);   // частота уже сверена выше
+    double ePer = fabs((double)periodQ - wantP) / wantP;
+    if (ePer > maxPer) maxPer = ePer;
+    if (ePer > 0.002) badPer++;
+  }
+  printf("  flow %ld..%ld x%lu: rate err max %.0f mHz, period err max %.3f%%\n",
+         (long)r.mn, (long)r.mx, (unsigned long)r.gain, maxRate, maxPer * 100);
+  CHECK_EQ(badRate, 0u);
+  CHECK_EQ(badPer, 0u);
+}
+
+int main() {
+  CHECK_EQ(pumpLutRate_mHz(100), 0u);   // таблицы ещё нет
+
+  static const Range ranges[] = {
+    { 0,    1000,  1000 },   // с нуля: узел 0 = 0 mHz
+    { 25,   200,   1000 },   // умолчания (rec * kmin..kmax)
+    { 500,  2000,  6000 },
+    { 100,  5000,  200 },
+    { 0,    20,    10 },     // весь диапазон ниже минимума Timer1
+    { 3000, 20000, 30000 },  // верх упирается в PUMP_MAX_STEP_HZ
+  };
+  for (const Range &r : ranges) sweep(r);
+
+  // та же эпоха — таблица не трогается, даже если вход другой
+  pumpLutSync(epoch, 0, 1000, 2000, POT_ADC_MAX);
+  CHECK_EQ(pumpLutRate_mHz(POT_ADC_MAX), (uint32_t)directMHz(3000, 20000, 30000, POT_ADC_MAX));
+
+  // 256 правок в меню между синхронизациями: эпоха не совпадает со старой
+  uint16_t old = ++epoch;
+  pumpLutSync(old, 0, 1000, 1000, POT_ADC_MAX);
+  epoch = (uint16_t)(old + 256);
+  pumpLutSync(epoch, 0, 1000, 2000, POT_ADC_MAX);
+  CHECK_EQ(pumpLutRate_mHz(POT_ADC_MAX), (uint32_t)directMHz(0, 1000, 2000, POT_ADC_MAX));
+
+  return checkResult("test_lut");
+}
@@ -0,0 +1,119 @@
+// Фильтр POT на синтетических трассах АЦП (шкала potGetAvgAdc,
+// 0..4092), против прежнего IIR 7/8:
+//  - ступень большая и малая: опросов до входа в +-deadband, без перелёта;
+//  - покой с шумом +-POT_FILT_NOISE: выход стоит (deadband) или шум
+//    ослаблен (без deadband);
+//  - медленный поворот: отставание ограничено;
+//  - края шкалы 0 и POT_ADC_MAX достижимы при любом deadband.
+// Записанной с платы трассы нет: шум — равномерный +-POT_FILT_NOISE от
+// LCG, а сам POT_FILT_NOISE — оценка, не замер. Реальная наводка (сеть,
+// мотор) может быть не белой; порог и окна сверять по плате.
+#include <math.h>
+#include "check.h"
+#include "config.h"
+#include "pot.h"
+#include "pot_filter.h"
+
+static uint32_t rng = 12345;
+static int16_t noise(int16_t amp) {     // равномерный -amp..amp
+  rng = rng * 1103515245UL + 12345UL;
+  return (int16_t)((int32_t)((rng >> 16) % (2 * amp + 1)) - amp);
+}
+
+static uint16_t clampAdc(int32_t v) {
+  return (v < 0) ? 0 : (v > POT_ADC_MAX) ? POT_ADC_MAX : (uint16_t)v;
+}
+
+// прежний путь: y += (x - y) / 8
+struct Iir78 {
+  int32_t y;
+  uint16_t update(uint16_t x) { y += ((int32_t)x - y) / 8; return (uint16_t)y; }
+};
+
+// опросов, пока выход не войдёт в +-tol от to (и больше не выйдет)
+static uint32_t settle(uint16_t from, uint16_t to, uint16_t tol, uint16_t db,
+                       int16_t amp, bool *overshoot, uint32_t *iirPolls) {
+  potFilterSetDeadband(db);
+  potFilterReset(from);
+  Iir78 iir = { from };
+  uint32_t last = 0, iirLast = 0;
+  *overshoot = false;
+  for (uint32_t i = 1; i <= 2000; i++) {
+    uint16_t x = clampAdc(to + noise(amp));
+    uint16_t y = potFilterUpdate(x);
+    uint16_t yi = iir.update(x);
+    if (abs((int)y - (int)to) > tol) last = i;
+    if (abs((int)yi - (int)to) > tol) iirLast = i;
+    if ((to > from && y > to + tol) || (to < from && y + tol < to)) *overshoot = true;
+  }
+  *iirPolls = iirLast + 1;   // 2001 — не дошёл (целое /8 застревает до 7 отсчётов)
+  return last + 1;
+}
+
+int main() {
+  for (uint8_t N = 4; N <= 16; N <<= 1) {
+    potFilterSetWindow(N);
+    bool over;
+    uint32_t iir;
+
+    // ===== большая ступень: ручку резко довернули =====
+    uint32_t big = settle(1000, 3000, 8, 8, 0, &over, &iir);
+    printf("  N=%2u  step 1000->3000: %3u polls (IIR 7/8: %3u)", N, (unsigned)big, (unsigned)iir);
+    CHECK(big <= 8);
+    CHECK(big < iir / 4);
+    CHECK(!over);
+
+    // ===== малая ступень (3x шум): сглаживание, но доходит =====
+    uint32_t small = settle(2000, 2000 + 3 * POT_FILT_NOISE, 2, 0, 0, &over, &iir);
+    printf("  step +%u: %3u polls (IIR %3u)", 3 * POT_FILT_NOISE, (unsigned)small, (unsigned)iir);
+    CHECK(small <= 8u * N);
+    CHECK(!over);
+
+    // ===== покой с шумом =====
+    potFilterSetDeadband(0);
+    potFilterReset(2000);
+    Iir78 iirRest = { 2000 };
+    double seIn = 0, seOut = 0, seIir = 0;
+    const uint32_t REST = 20000;
+    for (uint32_t i = 0; i < REST; i++) {
+      uint16_t x = clampAdc(2000 + noise(POT_FILT_NOISE));
+      double d = (double)x - 2000, o = (double)potFilterUpdate(x) - 2000, q = (double)iirRest.update(x) - 2000;
+      seIn += d * d; seOut += o * o; seIir += q * q;
+    }
+    double rIn = sqrt(seIn / REST), rOut = sqrt(seOut / REST), rIir = sqrt(seIir / REST);
+    CHECK(rOut < rIn / (N >= 8 ? 2.0 : 1.5));
+
+    // с deadband 2 * шум выход на месте
+    potFilterSetDeadband(2 * POT_FILT_NOISE);
+    potFilterReset(2000);
+    uint32_t moves = 0;
+    uint16_t prev = potFilterOut();
+    for (uint32_t i = 0; i < REST; i++) {
+      uint16_t y = potFilterUpdate(clampAdc(2000 + noise(POT_FILT_NOISE)));
+      if (y != prev) moves++;
+      prev = y;
+    }
+    printf("  rest rms %.2f -> %.2f (IIR %.2f), moves %u\n", rIn, rOut, rIir, (unsigned)moves);
+    CHECK_EQ(moves, 0u);
+
+    // ===== медленный поворот 2 отсчёта за опрос =====
+    potFilterSetDeadband(4);
+    potFilterReset(500);
+    int32_t lagMax = 0;
+    for (int32_t x = 500; x <= 3500; x += 2) {
+      uint16_t y = potFilterUpdate(clampAdc(x + noise(POT_FILT_NOISE / 2)));
+      if (x - (int32_t)y > lagMax) lagMax = x - (int32_t)y;
+    }
+    CHECK(lagMax <= 4 + 2 * N);
+
+    // ===== края шкалы =====
+    potFilterSetDeadband(200);
+    potFilterReset(100);
+    for (uint8_t i = 0; i < 200; i++) potFilterUpdate(0);
+    CHECK_EQ(potFilterOut(), 0);
+    potFilterReset(POT_ADC_MAX - 100);
+    for (uint8_t i = 0; i < 200; i++) potFilterUpdate(POT_ADC_MAX);
+    CHECK_EQ(potFilterOut(), POT_ADC_MAX);
+  }
+  return checkResult("test_pot_filter");
+}
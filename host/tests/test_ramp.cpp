@@ -0,0 +1,199 @@
+// Рампа: частота каждого шага на D9 против трапеции
+// RAMP_START + a*t при разгоне и торможении.
+//  - разгон и торможение монотонны и идут по прямой заданного ускорения
+//    (отступ — пол-ступени PUMP_RAMP_LEVEL_HZ и тик);
+//  - длительность рампы (f - RAMP_START) / a, +-1%;
+//  - стоп посреди разгона тормозит с текущей частоты, а не с крейсерской;
+//  - PULSE: смена частоты в ON-фазе — рампой от достигнутой;
+//  - короткая рампа не быстрее заданного ускорения, и на предельном
+//    ускорении частота соседних шагов не прыгает больше стартовой;
+//  - после торможения STEP и ENA сняты, счёт шагов = фронтам.
+#include <math.h>
+#include <vector>
+#include "sim.h"
+#include "check.h"
+#include "config.h"
+#include "pump.h"
+#include "types.h"
+
+static std::vector<uint64_t> edges;
+
+static void onStep(uint64_t cycle, uint8_t level) {
+  if (level) edges.push_back(cycle);
+}
+
+// частота шага k (по периоду от предыдущего фронта), Гц
+static double freqAt(size_t k) {
+  return (double)F_CPU / (double)(edges[k] - edges[k - 1]);
+}
+
+static double msSince(uint64_t t0, size_t k) {
+  return (double)(edges[k] - t0) / SIM_CYCLES_PER_MS;
+}
+
+static const double START_HZ = PUMP_RAMP_START_HZ;
+static const double ACCEL = 20000;     // шаг/с^2
+static const double DECEL = 40000;
+static const double TARGET_HZ = 20000;
+// ступень рампы — середина отрезка прямой, отходит от неё не больше чем на
+// пол-ступени (PUMP_RAMP_LEVEL_HZ / 2); плюс мс тика Timer2 и полпериода
+// шага, на которые частота по фронтам отстаёт от момента фронта
+static double levelSlack(double a) {
+  return PUMP_RAMP_LEVEL_HZ / 2.0 + a * 0.001 + a / (2.0 * START_HZ);
+}
+
+int main() {
+  pumpBegin();
+  pumpSetEnable(true);
+  pumpSetRamp((uint32_t)ACCEL, (uint32_t)DECEL);
+  simOnStep = onStep;
+
+  uint32_t cnt0 = pumpGetStepCount();
+  uint64_t rise0 = simStepRising();
+
+  // ===== разгон 200 Гц -> 20 кГц =====
+  uint64_t tStart = simCycles();
+  pumpStartSteps((uint32_t)TARGET_HZ);
+  simRunMs(1500);
+
+  double span = TARGET_HZ - START_HZ;
+  double slackUp = levelSlack(ACCEL);
+  double prev = 0, accelEndMs = -1;
+  uint32_t aboveLine = 0, notMonotonic = 0;
+  for (size_t k = 1; k < edges.size(); k++) {
+    double f = freqAt(k), t = msSince(tStart, k);
+    double line = START_HZ + ACCEL * t / 1000.0;
+    if (line > TARGET_HZ) line = TARGET_HZ;
+    if (fabs(f - line) > slackUp) aboveLine++;
+    if (f < prev * 0.995) notMonotonic++;
+    if (accelEndMs < 0 && f >= TARGET_HZ * 0.999) accelEndMs = t;
+    prev = f;
+  }
+  double accelMs = span / ACCEL * 1000.0;
+  printf("  accel: %zu steps, cruise after %.1f ms (plan %.1f)\n", edges.size(), accelEndMs, accelMs);
+  CHECK_EQ(aboveLine, 0u);
+  CHECK_EQ(notMonotonic, 0u);
+  CHECK(fabs(accelEndMs - accelMs) <= accelMs * 0.01 + 2);
+  CHECK(fabs(freqAt(edges.size() - 1) - TARGET_HZ) <= TARGET_HZ * 1e-3);
+
+  // ===== торможение 20 кГц -> стоп =====
+  size_t k0 = edges.size();
+  uint64_t tStop = simCycles();
+  pumpStop();
+  while (pumpIsRunning()) simRunMs(1);
+  double stopMs = (double)(simCycles() - tStop) / SIM_CYCLES_PER_MS;
+
+  double slackDown = levelSlack(DECEL);
+  prev = TARGET_HZ * 1.001;
+  aboveLine = notMonotonic = 0;
+  for (size_t k = k0 + 1; k < edges.size(); k++) {
+    double f = freqAt(k), t = msSince(tStop, k);
+    double line = TARGET_HZ - DECEL * t / 1000.0;
+    if (line < START_HZ) line = START_HZ;
+    if (fabs(f - line) > slackDown) aboveLine++;
+    if (f > prev * 1.005) notMonotonic++;
+    prev = f;
+  }
+  double decelMs = span / DECEL * 1000.0;
+  printf("  decel: %zu steps, stopped after %.1f ms (plan %.1f), last %.0f Hz\n",
+         edges.size() - k0, stopMs, decelMs, freqAt(edges.size() - 1));
+  CHECK_EQ(aboveLine, 0u);
+  CHECK_EQ(notMonotonic, 0u);
+  CHECK(fabs(stopMs - decelMs) <= decelMs * 0.01 + 2);
+  // последний шаг начался на период шага (до 1/START_HZ) раньше конца рампы
+  CHECK(freqAt(edges.size() - 1) <= START_HZ + slackDown + DECEL / START_HZ);
+  CHECK_EQ(simPinLevel(PIN_ENA), 1);   // disable (inverted)
+
+  // ===== стоп посреди разгона =====
+  simRunMs(20);
+  edges.clear();
+  pumpStartSteps((uint32_t)TARGET_HZ);
+  simRunMs(300);                        // ~6 кГц из 20
+  size_t kMid = edges.size();
+  double fMid = freqAt(kMid - 1);
+  pumpStop();
+  while (pumpIsRunning()) simRunMs(1);
+
+  double fMax = 0;
+  for (size_t k = kMid; k < edges.size(); k++) fMax = fmax(fMax, freqAt(k));
+  printf("  stop mid-accel at %.0f Hz: max after stop %.0f Hz\n", fMid, fMax);
+  CHECK(fMid < TARGET_HZ * 0.5);
+  CHECK(fMax <= fMid + levelSlack(ACCEL));
+
+  // ===== короткая рампа =====
+  // 62 мс разгона — столько же, а не быстрее: короткая рампа тоже идёт с
+  // заданным ускорением
+  simRunMs(20);
+  const double SHORT_HZ = START_HZ + ACCEL * 0.062;
+  edges.clear();
+  tStart = simCycles();
+  pumpStartSteps((uint32_t)SHORT_HZ);
+  simRunMs(150);
+  double shortMs = -1;
+  for (size_t k = 1; k < edges.size() && shortMs < 0; k++) {
+    if (freqAt(k) >= SHORT_HZ * 0.999) shortMs = msSince(tStart, k);
+  }
+  printf("  short ramp to %.0f Hz: %.1f ms (plan 62.0)\n", SHORT_HZ, shortMs);
+  CHECK(fabs(shortMs - 62.0) <= 2 + 1000.0 / START_HZ);
+  pumpStopNow();
+
+  // ===== предельное ускорение =====
+  // соседние шаги (короче ступени в 1 мс) не расходятся больше чем на
+  // стартовую частоту
+  simRunMs(20);
+  pumpSetRamp(200000, 200000);
+  edges.clear();
+  pumpStartSteps((uint32_t)TARGET_HZ);
+  simRunMs(200);
+  double maxJump = 0;
+  for (size_t k = 2; k < edges.size(); k++) {
+    if (freqAt(k - 1) < 2000) continue;   // шаг длиннее ступени: там частота растёт и внутри шага
+    maxJump = fmax(maxJump, freqAt(k) - freqAt(k - 1));
+  }
+  printf("  accel 200000: max jump between steps %.0f Hz\n", maxJump);
+  CHECK(maxJump <= START_HZ + TARGET_HZ * TARGET_HZ / F_CPU * 2);   // + тик таймера
+  pumpStop();
+  while (pumpIsRunning()) simRunMs(1);
+
+  // ===== PULSE: новая частота посреди ON-фазы =====
+  // от достигнутой частоты к новой — рампой, а не скачком
+  simRunMs(20);
+  pumpSetRamp((uint32_t)ACCEL, (uint32_t)DECEL);
+  Settings ps = {};
+  ps.pulse_on_ms = 2000;
+  ps.pulse_off_ms = 500;
+  bool phaseOn = false;
+  uint32_t phaseMs = 0;
+  const double P1_HZ = 4000, P2_HZ = 12000;
+  edges.clear();
+  for (int i = 0; i < 400; i++) {       // разгон до P1 и крейсер
+    pumpRunPulse(phaseOn, phaseMs, ps, (uint32_t)(P1_HZ * 1000));
+    simRunMs(1);
+  }
+  size_t kChange = edges.size();
+  uint64_t tChange = simCycles();
+  for (int i = 0; i < 800; i++) {
+    pumpRunPulse(phaseOn, phaseMs, ps, (uint32_t)(P2_HZ * 1000));
+    simRunMs(1);
+  }
+  CHECK(phaseOn);
+  double pulseUpMs = -1, pulseOff = 0;
+  for (size_t k = kChange + 1; k < edges.size(); k++) {
+    double f = freqAt(k), t = msSince(tChange, k);
+    double line = fmin(P1_HZ + ACCEL * t / 1000.0, P2_HZ);
+    pulseOff = fmax(pulseOff, f - line);
+    if (pulseUpMs < 0 && f >= P2_HZ * 0.999) pulseUpMs = t;
+  }
+  double pulsePlanMs = (P2_HZ - P1_HZ) / ACCEL * 1000.0;
+  printf("  pulse %.0f -> %.0f Hz in ON: %.1f ms (plan %.1f), max above line %.0f Hz\n",
+         P1_HZ, P2_HZ, pulseUpMs, pulsePlanMs, pulseOff);
+  CHECK(pulseOff <= levelSlack(ACCEL));
+  CHECK(fabs(pulseUpMs - pulsePlanMs) <= pulsePlanMs * 0.01 + 2);
+  pumpStopNow();
+
+  simRunMs(20);
+  simOnStep = nullptr;
+  CHECK_EQ(simPinLevel(PIN_STEP), 0);
+  CHECK_EQ(pumpGetStepCount() - cnt0, simStepRising() - rise0);
+  return checkResult("test_ramp");
+}
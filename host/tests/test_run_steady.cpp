@@ -0,0 +1,73 @@
+// Крейсер RUN: пока уставка POT не меняется, Timer1 не перезаряжается —
+// в CONT pumpGetReprogramCount() стоит, после поворота POT растёт; в PULSE
+// без рампы — не больше одной перезарядки на ON-фазу.
+#include "sim.h"
+#include "check.h"
+#include "mql_2004_I2C_encoder_V2.ino"
+
+static void run(uint32_t ms) {
+  for (uint32_t i = 0; i < ms * 10; i++) {
+    loop();
+    simRun(1600);   // ~100 мкс на проход loop()
+  }
+}
+
+static void press(uint8_t pin) {
+  simPinDrive(pin, 0);
+  run(100);
+  simPinRelease(pin);
+  run(150);
+}
+
+static uint32_t steadyReprograms(Mode mode) {
+  S.mode = mode;
+  press(PIN_START_BTN);                      // READY -> RUN
+  CHECK_EQ(state, ST_RUN);
+  run(2000);                                 // разгон закончен
+  CHECK(pumpIsRunning() || mode == MODE_PULSE);
+
+  uint32_t r0 = pumpGetReprogramCount();
+  uint32_t s0 = pumpGetStepCount();
+  run(3000);
+  uint32_t dr = pumpGetReprogramCount() - r0;
+  uint32_t ds = pumpGetStepCount() - s0;
+  printf("  %s: %u steps, %u Timer1 reprograms in 3 s\n",
+         mode == MODE_CONT ? "CONT" : "PULSE", (unsigned)ds, (unsigned)dr);
+  CHECK(ds > 0);
+  return dr;
+}
+
+int main() {
+  simAdcSet(PIN_POT - A0, 512);
+  simPinDrive(PIN_BTN_UP, 1);
+  simPinDrive(PIN_BTN_DOWN, 1);
+  setup();
+  // крутой насос: ~3.7 кГц на середине POT, разгон через рампу
+  S.pump_gain_steps_per_u_min = 200000;
+  rangeEpoch++;
+  run(500);
+
+  CHECK_EQ(steadyReprograms(MODE_CONT), 0u);
+
+  // поворот POT: новая уставка — новый период
+  uint32_t r0 = pumpGetReprogramCount();
+  simAdcSet(PIN_POT - A0, 700);
+  run(1000);
+  CHECK(pumpGetReprogramCount() > r0);
+
+  press(PIN_START_BTN);                      // RUN -> READY
+  run(1000);
+  CHECK_EQ(state, ST_READY);
+  CHECK(!pumpIsRunning());
+
+  // PULSE: каждая ON-фаза — разгон заново, так что здесь считаем только
+  // OFF-фазы и крейсер: без разгона они Timer1 не трогают
+  S.accel_steps_s2 = 0;
+  S.decel_steps_s2 = 0;
+  uint32_t pulse = steadyReprograms(MODE_PULSE);
+  // одна перезарядка на ON-фазу (запуск с нуля), не больше
+  uint32_t cycles = 3000 / (S.pulse_on_ms + S.pulse_off_ms) + 1;
+  CHECK(pulse <= cycles);
+
+  return checkResult("test_run_steady");
+}
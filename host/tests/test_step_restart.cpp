@@ -0,0 +1,34 @@
+// STEP (OC1A): остановка посреди шага и сразу новый запуск не должны
+// сбивать счёт — pumpGetStepCount() совпадает с числом фронтов на D9
+#include "sim.h"
+#include "check.h"
+#include "config.h"
+#include "pump.h"
+
+int main() {
+  pumpBegin();
+  pumpSetRamp(0, 0);
+
+  uint64_t rise0 = simStepRising();
+  uint32_t cnt0 = pumpGetStepCount();
+
+  for (int i = 0; i < 100; i++) {
+    pumpStartSteps(100);                       // медленно: шаги считает ISR Timer1
+    simRunMs(30 + i % 7);
+    while (!simPinLevel(PIN_STEP)) simRun(100); // стоп, пока STEP = HIGH:
+    pumpStopNow();                             // clear на совпадении ещё не пришёл
+    simRun(1000);
+
+    pumpStartSteps(100);                       // и сразу снова
+    simRunMs(30 + i % 5);
+    while (simPinLevel(PIN_STEP)) simRun(100);  // этот стоп — на LOW
+    pumpStopNow();
+    simRunMs(20);
+  }
+  pumpStopNow();
+  simRunMs(50);
+
+  CHECK_EQ(simPinLevel(PIN_STEP), 0);
+  CHECK_EQ(pumpGetStepCount() - cnt0, simStepRising() - rise0);
+  return checkResult("test_step_restart");
+}
@@ -0,0 +1,157 @@
+// Общий счёт масла:
+//  - старт новой работы, пока прошлая ещё тормозит, не теряет её шаги —
+//    общий счёт совпадает со всеми шагами насоса;
+//  - пустая EEPROM — счёт с нуля, сохранённый читается обратно;
+//  - сохранения идут по кругу слотов журнала: износ ячейки ~ 1/EE_TOTAL_SLOTS;
+//  - запись, оборванная питанием, отбрасывается по CRC — остаётся прошлый счёт;
+//  - шаги -> мл приростом (32 бита) совпадает с прежним 64-битным расчётом.
+#include "sim.h"
+#include "check.h"
+#include "config.h"
+#include "pump.h"
+#include "settings.h"
+#include "eestore.h"
+#include "totalizer.h"
+
+static constexpr uint16_t TOTAL_BASE = (uint16_t)EE_LOG_SLOTS * EE_LOG_SLOT_SIZE;
+
+// прежний расчёт totalizerStepsToMl_x100
+static int32_t refMl_x100(uint32_t steps) {
+  uint64_t ml = ((uint64_t)steps * S.ml_per_u_x1000 / 10ULL + S.pump_gain_steps_per_u_min / 2)
+                / S.pump_gain_steps_per_u_min;
+  return (ml > 0x7FFFFFFFULL) ? 0x7FFFFFFFL : (int32_t)ml;
+}
+
+static uint32_t rng = 1;
+static uint32_t rnd(uint32_t n) {
+  rng = rng * 1103515245UL + 12345UL;
+  return (rng >> 8) % n;
+}
+
+static void runMs(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    totalizerPoll();
+    simRunMs(1);
+  }
+}
+
+static void settle() {
+  runMs(10);
+  while (eeStoreBusy()) runMs(1);
+}
+
+// короткая работа на 2 кГц без торможения
+static void job(uint32_t ms) {
+  totalizerJobStart();
+  pumpStartSteps(2000);
+  runMs(ms);
+  pumpStopNow();
+  totalizerJobStop();
+}
+
+int main() {
+  S.calibrated = true;
+  S.pump_gain_steps_per_u_min = 1000;   // 1000 шагов = 1 u = 1 мл
+  S.ml_per_u_x1000 = 1000;
+
+  // ===== пустая EEPROM =====
+  totalizerBegin();
+  CHECK_EQ(totalizerLifetimeMl_x100(), 0u);
+
+  // ===== работа, стартующая на торможении прошлой =====
+  pumpBegin();
+  pumpSetEnable(true);
+  pumpSetRamp(4000, 4000);              // торможение с 2 кГц ~0.45 с
+  uint32_t total0 = totalizerLifetimeMl_x100();
+  uint32_t cnt0 = pumpGetStepCount();
+
+  for (int i = 0; i < 5; i++) {
+    totalizerJobStart();
+    pumpStartSteps(2000);
+    runMs(700);
+    pumpStop();
+    totalizerJobStop();
+    runMs(100);                         // ещё тормозит
+    CHECK(pumpIsRunning());
+  }
+  totalizerJobStart();
+  pumpStartSteps(2000);
+  runMs(700);
+  pumpStop();
+  totalizerJobStop();
+  runMs(1000);
+  CHECK(!pumpIsRunning());
+  settle();
+
+  uint32_t steps = pumpGetStepCount() - cnt0;
+  uint32_t added = totalizerLifetimeMl_x100() - total0;
+  printf("  %u steps, lifetime +%u ml x100\n", (unsigned)steps, (unsigned)added);
+  // по работе округление до 0.01 мл
+  CHECK(added + 6 >= steps / 10 && added <= steps / 10 + 6);
+
+  // ===== износ =====
+  pumpSetRamp(0, 0);
+  uint32_t wear0[EE_TOTAL_SLOTS * EE_TOTAL_SLOT_SIZE];
+  for (uint16_t i = 0; i < EE_TOTAL_SLOTS * EE_TOTAL_SLOT_SIZE; i++) wear0[i] = simEeWrites(TOTAL_BASE + i);
+  const uint32_t SAVES = 140;
+  for (uint32_t i = 0; i < SAVES; i++) {
+    job(20);
+    settle();
+  }
+  uint32_t wearMax = 0;
+  for (uint16_t i = 0; i < EE_TOTAL_SLOTS * EE_TOTAL_SLOT_SIZE; i++) {
+    uint32_t w = simEeWrites(TOTAL_BASE + i) - wear0[i];
+    if (w > wearMax) wearMax = w;
+  }
+  printf("  %u saves: max %u writes per cell\n", (unsigned)SAVES, (unsigned)wearMax);
+  CHECK(wearMax <= SAVES / EE_TOTAL_SLOTS + 1);
+
+  uint32_t saved = totalizerLifetimeMl_x100();
+  totalizerBegin();
+  CHECK_EQ(totalizerLifetimeMl_x100(), saved);
+
+  // ===== обрыв питания посреди записи =====
+  // после обрыва — прошлый счёт или новый целиком, ничего третьего
+  uint32_t kept = 0;
+  for (uint8_t cut = 1; cut <= 6; cut++) {
+    job(50);
+    while (!eeStoreBusy()) runMs(1);
+    uint32_t cur = totalizerLifetimeMl_x100();
+    simRun(cut * 54400ULL - 1000);      // cut-й байт ещё пишется
+    simEePower(false);
+    while (eeStoreBusy()) simRunMs(1);
+    simEePower(true);
+
+    totalizerBegin();
+    uint32_t got = totalizerLifetimeMl_x100();
+    CHECK(got == saved || got == cur);
+    if (got == saved) kept++;
+    saved = got;
+  }
+  CHECK(kept > 0);
+
+  // ===== шаги -> мл =====
+  // как в RUN: счёт растёт понемногу, изредка скачком, с нуля на новой
+  // работе; калибровка меняется между работами
+  static const uint32_t cal[][2] = {   // gain, ml_per_u_x1000
+    { 1000, 1000 }, { 50, 10000000 }, { 50000, 1 }, { 3200, 1537 }, { 777, 123456 },
+  };
+  uint32_t bad = 0;
+  for (const auto &c : cal) {
+    S.pump_gain_steps_per_u_min = c[0];
+    S.ml_per_u_x1000 = c[1];
+    for (int jobN = 0; jobN < 3; jobN++) {
+      uint32_t st = 0;
+      for (int i = 0; i < 20000; i++) {
+        st += (rnd(100) == 0) ? rnd(2000000) : rnd(1200);   // ~10 мс на 100 кГц
+        if (totalizerStepsToMl_x100(S, st) != refMl_x100(st)) bad++;
+      }
+      if (totalizerStepsToMl_x100(S, 0xFFFFFFFFUL) != refMl_x100(0xFFFFFFFFUL)) bad++;
+    }
+  }
+  CHECK_EQ(bad, 0u);
+  S.calibrated = false;
+  CHECK_EQ(totalizerStepsToMl_x100(S, 1000), -1);
+
+  return checkResult("test_totalizer");
+}
@@ -1,48 +1,111 @@
 #include "config.h"
 #include "input.h"
 #include "encoder_k040.h"
+#include "input_queue.h"
+#include "pot.h"
 
 static EncoderK040 encoder;
 
+// Состояние, восстановленное из потока событий
+static uint16_t lastDetentMs = 0;
+static int8_t   lastDetentDir = 0;
+
+// Клик/удержание — одинаково для всех кнопок, по меткам времени событий
+struct BtnTrack {
+  bool     down;
+  bool     holdFired;
+  uint16_t downMs;
+};
+static BtnTrack btn[BTN_COUNT];
+
+// Что кнопка дала за этот опрос
+struct BtnOut {
+  bool press, click, hold;
+};
+
 void inputBegin() {
   // Encoder pins из config.h:
   //  PIN_BTN_UP   -> ENC A
   //  PIN_BTN_DOWN -> ENC B
   //  PIN_BTN_OK   -> ENC BTN
-  encoder.begin(PIN_BTN_UP, PIN_BTN_DOWN, PIN_BTN_OK);
+  encoder.begin(PIN_BTN_UP, PIN_BTN_DOWN);
+  inputQueueBegin(PIN_BTN_OK, PIN_START_BTN);
 
-  pinMode(PIN_START_BTN, INPUT_PULLUP);
-  pinMode(PIN_POT, INPUT);
+  potBegin();
+}
+
+// Множитель по интервалу между щелчками (кривая из config.h)
+static uint8_t accelFromDt(uint16_t dtMs) {
+  uint8_t mult = 1;
+  for (uint8_t i = 0; i < ENC_ACCEL_LEVELS; i++) {
+    if (dtMs <= ENC_ACCEL_DT_MS[i]) mult = ENC_ACCEL_MULT[i];
+  }
+  return mult;
 }
 
 void inputPoll(InputEvents &ev) {
   ev = {};
 
-  // Энкодер
-  EncoderEvents e = encoder.poll();
-  ev.encStep  = e.step;
-  ev.encClick = e.click;
+  // Все события с прошлого опроса по порядку; время — из меток ISR,
+  // поэтому задержка loop() не превращает клик в удержание и наоборот
+  BtnOut out[BTN_COUNT] = {};
+  InputEv e;
+  while (inputQueuePop(e)) {
+    switch (e.type) {
+      case IEV_DETENT: {
+        // скорость — по интервалу между соседними щелчками, разворот = с нуля
+        uint16_t dt = (e.arg == lastDetentDir) ? (uint16_t)(e.ms - lastDetentMs) : 0xFFFF;
+        lastDetentMs = e.ms;
+        lastDetentDir = e.arg;
+        if (ev.encStep > -100 && ev.encStep < 100) ev.encStep += e.arg;
+        uint8_t a = accelFromDt(dt);
+        if (a > ev.encAccel) ev.encAccel = a;
+      } break;
 
-  // Длинное нажатие энкодера = MENU/BACK
-  ev.menuClick = e.hold;
+      case IEV_BTN_DOWN:
+      case IEV_BTN_UP: {
+        if ((uint8_t)e.arg >= BTN_COUNT) break;
+        BtnTrack &b = btn[e.arg];
+        BtnOut &o = out[e.arg];
+        if (e.type == IEV_BTN_DOWN) {
+          b.down = true;
+          b.holdFired = false;
+          b.downMs = e.ms;
+          o.press = true;
+        } else {
+          if (b.down && !b.holdFired) {
+            if ((uint16_t)(e.ms - b.downMs) >= ENC_BTN_LONG_MS) o.hold = true;
+            else o.click = true;
+          }
+          b.down = false;
+        }
+      } break;
 
-  // START кнопка (как было)
-  static uint8_t lastStart = HIGH;
-  uint8_t nowStart = digitalRead(PIN_START_BTN);
-  if (lastStart == HIGH && nowStart == LOW) ev.startClick = true;
-  lastStart = nowStart;
+      default:
+        break;
+    }
+  }
 
-  // Потенциометр (скользящее среднее)
-  static uint16_t pAvg = 0;
-  pAvg = (pAvg * 7 + analogRead(PIN_POT)) / 8;
-}
+  // удержание срабатывает, не дожидаясь отпускания
+  uint16_t now = (uint16_t)millis();
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    BtnTrack &b = btn[i];
+    if (b.down && !b.holdFired && (uint16_t)(now - b.downMs) >= ENC_BTN_LONG_MS) {
+      b.holdFired = true;
+      out[i].hold = true;
+    }
+  }
 
-uint16_t potGetAvgAdc() {
-  static uint16_t lastPot = 0;
-  lastPot = (lastPot * 7 + analogRead(PIN_POT)) / 8;
-  return lastPot;
+  ev.encClick   = out[BTN_OK].click;
+  ev.menuClick  = out[BTN_OK].hold;      // длинное нажатие энкодера = MENU/BACK
+  ev.startClick = out[BTN_START].press;  // START — сразу по нажатию
 }
 
-void potSetFilterN(uint8_t N) {
-  (void)N;
+int32_t encAccelDelta(int8_t step, uint8_t accel, int32_t base, int32_t span) {
+  int32_t inc = base * accel;
+  int32_t maxInc = span / ENC_ACCEL_MIN_SWEEP;
+  maxInc -= maxInc % base;      // остаёмся на сетке шага поля
+  if (inc > maxInc) inc = maxInc;
+  if (inc < base) inc = base;
+  return inc * step;
 }
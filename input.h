@@ -3,7 +3,8 @@
 
 // Структура событий ввода (энкодер + кнопки)
 struct InputEvents {
-  int8_t  encStep     = 0;
+  int8_t  encStep     = 0;      // щелчков за poll, со знаком
+  uint8_t encAccel    = 1;      // множитель по скорости вращения
   bool    encClick    = false;
   bool    encLong     = false;
   bool    menuClick   = false;
@@ -13,6 +14,8 @@ struct InputEvents {
 void inputBegin();
 void inputPoll(InputEvents &ev);
 
-// Функции для потенциометра
-void potSetFilterN(uint8_t N);
-uint16_t potGetAvgAdc();
\ No newline at end of file
+// Приращение числового поля с ускорением: step щелчков по base, быстрее —
+// кратно base, но весь диапазон span не быстрее ENC_ACCEL_MIN_SWEEP щелчков
+int32_t encAccelDelta(int8_t step, uint8_t accel, int32_t base, int32_t span);
+
+// Потенциометр — pot.h
\ No newline at end of file
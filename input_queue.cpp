@@ -0,0 +1,115 @@
+#include <avr/interrupt.h>
+#include "config.h"
+#include "input_queue.h"
+
+static_assert((INPUT_QUEUE & (INPUT_QUEUE - 1)) == 0, "INPUT_QUEUE must be a power of 2");
+static constexpr uint8_t QMASK = INPUT_QUEUE - 1;
+
+static InputEv q[INPUT_QUEUE];
+static volatile uint8_t qHead = 0;   // пишут ISR
+static volatile uint8_t qTail = 0;   // читает loop()
+static volatile uint8_t qDropped = 0;
+
+// Запись элемента должна лечь в память раньше, чем сдвинется индекс
+// (и прочитаться позже) — иначе компилятор вправе их переставить
+static inline void compilerBarrier() {
+  __asm__ __volatile__("" ::: "memory");
+}
+
+static void pushAt(uint8_t type, int8_t arg, uint16_t ms) {
+  uint8_t h = qHead;
+  uint8_t n = (uint8_t)(h + 1) & QMASK;
+  if (n == qTail) {
+    // полная: новое событие теряется, старые (и их порядок) целы
+    if (qDropped < 255) qDropped++;
+    return;
+  }
+  q[h].type = type;
+  q[h].arg = arg;
+  q[h].ms = ms;
+  compilerBarrier();
+  qHead = n;
+}
+
+void inputQueuePush(uint8_t type, int8_t arg) {
+  pushAt(type, arg, (uint16_t)millis());
+}
+
+bool inputQueuePop(InputEv &e) {
+  uint8_t t = qTail;
+  if (t == qHead) return false;
+  compilerBarrier();
+  e = q[t];
+  compilerBarrier();
+  qTail = (uint8_t)(t + 1) & QMASK;
+  return true;
+}
+
+uint8_t inputQueueDropped() {
+  return qDropped;
+}
+
+// Порт пина UNO на этапе компиляции (digitalPinToPort — таблица во flash):
+// D0..D7 — PORTD, D8..D13 — PORTB, A0..A5 — PORTC
+static constexpr uint8_t unoPinPort(uint8_t pin) {
+  return (pin < 8) ? PD : (pin < 14) ? PB : PC;
+}
+static_assert(unoPinPort(PIN_BTN_OK) == unoPinPort(PIN_START_BTN),
+              "PIN_BTN_OK and PIN_START_BTN must share one PINx port");
+
+// ======= Кнопки: вертикальные счётчики =======
+// Все кнопки читаются одним чтением PINx, и каждый бит порта дебаунсится
+// своим 2-битным счётчиком (биты счётчиков лежат "вертикально" в cnt0/cnt1),
+// так что любое число кнопок — те же несколько логических операций.
+// Бит меняет состояние после 4 опросов подряд, отличных от текущего.
+static volatile uint8_t* btnIn = nullptr;
+static uint8_t btnPortMask = 0;              // биты кнопок в PINx
+static uint8_t btnBit[BTN_COUNT];            // бит порта для InputBtn
+static uint8_t btnState = 0;                 // 1 = нажата (после антидребезга)
+static uint8_t cnt0 = 0, cnt1 = 0;
+static uint8_t btnDiv = 0;
+
+static inline void btnSample() {
+  uint8_t sample = (uint8_t)~*btnIn & btnPortMask;   // NO -> GND: 0 = нажата
+  uint8_t delta = sample ^ btnState;
+  cnt1 = (cnt1 ^ cnt0) & delta;
+  cnt0 = (uint8_t)~cnt0 & delta;
+  uint8_t toggle = delta & (uint8_t)~(cnt0 | cnt1);
+  if (!toggle) return;
+
+  btnState ^= toggle;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    if (toggle & btnBit[i]) {
+      inputQueuePush((btnState & btnBit[i]) ? IEV_BTN_DOWN : IEV_BTN_UP, (int8_t)i);
+    }
+  }
+}
+
+// Timer0 (millis) идёт всегда; COMPA на середине счёта — ещё одно
+// прерывание раз в ~1.024 мс, не трогая millis()
+ISR(TIMER0_COMPA_vect) {
+  if (++btnDiv < BTN_SAMPLE_MS) return;
+  btnDiv = 0;
+  btnSample();
+}
+
+void inputQueueBegin(uint8_t pinOk, uint8_t pinStart) {
+  const uint8_t pins[BTN_COUNT] = { pinOk, pinStart };
+
+  uint8_t sreg = SREG;
+  cli();
+  btnIn = portInputRegister(digitalPinToPort(pinOk));
+  btnPortMask = 0;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    pinMode(pins[i], INPUT_PULLUP);
+    btnBit[i] = digitalPinToBitMask(pins[i]);
+    btnPortMask |= btnBit[i];
+  }
+  // нажатая при старте кнопка событий не даёт
+  btnState = (uint8_t)~*btnIn & btnPortMask;
+  cnt0 = cnt1 = 0;
+
+  OCR0A = 0x80;
+  TIMSK0 |= (1 << OCIE0A);
+  SREG = sreg;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+
+// Очередь событий ввода: ISR (энкодер INT0/INT1, кнопки Timer0) -> loop().
+// Один производитель (ISR на AVR не вложены) и один потребитель (loop),
+// без запретов прерываний. События идут строго в порядке фронтов, каждое
+// с меткой millis(), так что долгий кадр UI или запись EEPROM их не теряет
+// и не путает (клик/удержание считаются по меткам, а не по времени опроса).
+
+enum InputEvType : uint8_t {
+  IEV_DETENT = 0,   // щелчок энкодера, arg = +1/-1 (уже с ENC_INVERT_DIR)
+  IEV_BTN_DOWN,     // кнопка нажата (после антидребезга), arg = InputBtn
+  IEV_BTN_UP        // отпущена, arg = InputBtn
+};
+
+enum InputBtn : uint8_t {
+  BTN_OK = 0,       // кнопка энкодера
+  BTN_START,
+  BTN_COUNT
+};
+
+struct InputEv {
+  uint8_t  type;    // InputEvType
+  int8_t   arg;
+  uint16_t ms;      // младшие 16 бит millis() в момент фронта
+};
+
+// Кнопки (NO -> GND). Все на одном порту: читаются одним чтением PINx.
+void inputQueueBegin(uint8_t pinOk, uint8_t pinStart);
+
+// Только из ISR (или при запрещённых прерываниях)
+void inputQueuePush(uint8_t type, int8_t arg);
+
+bool inputQueuePop(InputEv &e);     // loop(): false — пусто
+
+uint8_t inputQueueDropped();        // сколько событий не влезло (диагностика)
@@ -0,0 +1,252 @@
+#include "config.h"
+#include "lcd_async.h"
+#include "prof.h"
+
+// Биты PCF8574 на типовом модуле LCD2004
+static constexpr uint8_t PCF_RS = 0x01;
+static constexpr uint8_t PCF_EN = 0x04;
+static constexpr uint8_t PCF_BL = 0x08;
+
+// clear/home выполняются ~1.52 мс: после них шина крутит "пустые" байты
+// (без EN), 18 * 90 мкс на 100 кГц
+static constexpr uint8_t SLOW_CMD_PAD = (uint8_t)(1600UL * LCD_I2C_HZ / 9UL / 1000000UL + 1);
+
+static_assert((LCD_TX_QUEUE & (LCD_TX_QUEUE - 1)) == 0, "LCD_TX_QUEUE must be a power of 2");
+static constexpr uint8_t QMASK = LCD_TX_QUEUE - 1;
+
+// Очередь байт LCD; RS (команда/данные) — отдельной битовой маской
+static uint8_t q[LCD_TX_QUEUE];
+static uint8_t qRs[LCD_TX_QUEUE / 8];
+static volatile uint8_t qHead = 0;   // пишет loop()
+static volatile uint8_t qTail = 0;   // читает ISR
+
+static uint8_t pcfAddr = 0x27;
+static volatile uint8_t pcfBl = PCF_BL;
+static volatile bool twiActive = false;
+static uint32_t cmdCount = 0;         // команд HD44780 (clear, setCursor, ...)
+
+// Текущий байт LCD в ISR: фазы 0..4 — полубайты, дальше пауза
+static uint8_t curHi = 0, curLo = 0;
+static uint8_t curPhase = 0, curLen = 0;
+static bool curSent = false;          // в TWDR ушёл байт данных (не SLA)
+
+static inline uint8_t qCount() {
+  return (uint8_t)(qHead - qTail) & QMASK;
+}
+
+// Следующий байт для PCF8574 (из ISR)
+static bool nextPcfByte(uint8_t &out) {
+  if (curPhase >= curLen) {
+    uint8_t t = qTail;
+    if (t == qHead) return false;
+    uint8_t b = q[t];
+    uint8_t f = pcfBl | ((qRs[t >> 3] & (1 << (t & 7))) ? PCF_RS : 0);
+    qTail = (uint8_t)(t + 1) & QMASK;
+
+    curHi = (b & 0xF0) | f;
+    curLo = (uint8_t)(b << 4) | f;
+    curPhase = 0;
+    curLen = (!(f & PCF_RS) && b <= 0x03) ? (uint8_t)(5 + SLOW_CMD_PAD) : 5;
+  }
+
+  // RS до фронта EN, данные защёлкиваются по спаду EN
+  switch (curPhase++) {
+    case 0:  out = curHi; break;
+    case 1:  out = curHi | PCF_EN; break;
+    case 2:  out = curHi; break;
+    case 3:  out = curLo | PCF_EN; break;
+    default: out = curLo; break;
+  }
+  return true;
+}
+
+static constexpr uint8_t TWCR_RUN = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+
+// Начать транзакцию (при cli())
+static void twiKick() {
+  while (TWCR & (1 << TWSTO)) {}   // предыдущий STOP ещё уходит (~10 мкс)
+  twiActive = true;
+  TWCR = TWCR_RUN | (1 << TWSTA);
+}
+
+ISR(TWI_vect) {
+  PROF_SCOPE(PROF_ISR_TWI);
+
+  switch (TWSR & 0xF8) {
+    case 0x08:   // START
+    case 0x10:   // repeated START
+      TWDR = (uint8_t)(pcfAddr << 1);
+      TWCR = TWCR_RUN;
+      curSent = false;
+      return;
+
+    case 0x18:   // SLA+W ACK
+    case 0x28: { // data ACK
+      uint8_t b;
+      if (nextPcfByte(b)) {
+        TWDR = b;
+        TWCR = TWCR_RUN;
+        curSent = true;
+        return;
+      }
+      break;
+    }
+
+    case 0x38:   // потеря арбитража: на SLA байт данных ещё не уходил
+      if (!curSent) break;
+      // fallthrough
+    case 0x30:   // data NACK
+      // PCF8574 байт не принял: он уйдёт первым при следующем запуске
+      // (txBusyKick), иначе HD44780 потеряет полубайт и собьётся
+      curPhase--;
+      break;
+
+    default:     // SLA NACK: данные не трогали
+      break;
+  }
+
+  TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+  twiActive = false;
+}
+
+// Очередь не пуста или идёт передача. После NACK ISR отдал STOP, а байты
+// в очереди остались: их никто не отправит, пока не перезапустить отсюда —
+// иначе UI ждёт busy() вечно
+static bool txBusyKick() {
+  uint8_t sreg = SREG;
+  cli();
+  bool busy = twiActive || qCount();
+  if (!twiActive && qCount()) twiKick();
+  SREG = sreg;
+  return busy;
+}
+
+static void put(uint8_t b, bool rs) {
+  // полная очередь: ждём ISR (UI сюда не попадает, он смотрит txFree)
+  while (qCount() == QMASK) {
+    uint8_t sreg = SREG;
+    cli();
+    if (!twiActive) twiKick();
+    SREG = sreg;
+  }
+
+  uint8_t h = qHead;
+  q[h] = b;
+  if (rs) qRs[h >> 3] |= (uint8_t)(1 << (h & 7));
+  else    qRs[h >> 3] &= (uint8_t)~(1 << (h & 7));
+
+  uint8_t sreg = SREG;
+  cli();
+  qHead = (uint8_t)(h + 1) & QMASK;
+  if (!twiActive) twiKick();
+  SREG = sreg;
+}
+
+// ===== блокирующие записи для init() =====
+static void twiWait() {
+  while (!(TWCR & (1 << TWINT))) {}
+}
+
+static void pcfWriteNow(uint8_t b) {
+  TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+  twiWait();
+  TWDR = (uint8_t)(pcfAddr << 1);
+  TWCR = (1 << TWINT) | (1 << TWEN);
+  twiWait();
+  TWDR = b;
+  TWCR = (1 << TWINT) | (1 << TWEN);
+  twiWait();
+  TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+  while (TWCR & (1 << TWSTO)) {}
+}
+
+static void write4Now(uint8_t nibbleHi) {
+  pcfWriteNow(nibbleHi | pcfBl);
+  pcfWriteNow(nibbleHi | pcfBl | PCF_EN);
+  pcfWriteNow(nibbleHi | pcfBl);
+}
+
+LcdAsync::LcdAsync(uint8_t addr, uint8_t cols, uint8_t rows)
+  : _cols(cols), _rows(rows) {
+  pcfAddr = addr;
+}
+
+void LcdAsync::init() {
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, INPUT_PULLUP);
+  TWSR = 0;   // предделитель 1
+  TWBR = (uint8_t)((F_CPU / LCD_I2C_HZ - 16UL) / 2UL);
+  TWCR = (1 << TWEN);
+
+  // Сброс HD44780 в 4-битный режим (datasheet, fig. 24)
+  delay(50);
+  pcfWriteNow(pcfBl);
+  write4Now(0x30); delay(5);
+  write4Now(0x30); delay(5);
+  write4Now(0x30); delayMicroseconds(150);
+  write4Now(0x20);
+
+  command(0x28);   // 4 бита, 2 строки, 5x8
+  command(0x0C);   // дисплей вкл, без курсора
+  clear();
+  command(0x06);   // курсор вправо, без сдвига экрана
+  flush();
+}
+
+void LcdAsync::backlight() {
+  flush();
+  pcfBl = PCF_BL;
+  pcfWriteNow(pcfBl);
+}
+
+void LcdAsync::noBacklight() {
+  flush();
+  pcfBl = 0;
+  pcfWriteNow(pcfBl);
+}
+
+void LcdAsync::command(uint8_t c) {
+  cmdCount++;
+  put(c, false);
+}
+
+uint32_t LcdAsync::commandCount() const {
+  return cmdCount;
+}
+
+void LcdAsync::clear() {
+  command(0x01);
+}
+
+void LcdAsync::home() {
+  command(0x02);
+}
+
+void LcdAsync::setCursor(uint8_t col, uint8_t row) {
+  static const uint8_t rowOffs[4] = {0x00, 0x40, 0x14, 0x54};
+  if (row >= _rows) row = _rows - 1;
+  if (col >= _cols) col = _cols - 1;
+  command(0x80 | (uint8_t)(col + rowOffs[row & 3]));
+}
+
+void LcdAsync::createChar(uint8_t location, const uint8_t charmap[8]) {
+  command(0x40 | (uint8_t)((location & 7) << 3));
+  for (uint8_t i = 0; i < 8; i++) put(charmap[i], true);
+}
+
+size_t LcdAsync::write(uint8_t b) {
+  put(b, true);
+  return 1;
+}
+
+uint8_t LcdAsync::txFree() const {
+  return (uint8_t)(QMASK - qCount());
+}
+
+bool LcdAsync::busy() const {
+  return txBusyKick();
+}
+
+void LcdAsync::flush() {
+  while (txBusyKick()) {}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+// HD44780 через PCF8574 (4-битный режим) без Wire и без ожиданий в loop().
+// Те же методы, что использовались у LiquidCrystal_I2C. Байты LCD копятся в
+// кольцевой очереди, а ISR TWI раскладывает их на полубайты PCF8574 и гонит
+// одной I2C транзакцией, пока очередь не опустеет.
+class LcdAsync : public Print {
+public:
+  LcdAsync(uint8_t addr, uint8_t cols, uint8_t rows);
+
+  void init();   // блокирующая (задержки HD44780), только в setup()
+  void backlight();
+  void noBacklight();
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  void createChar(uint8_t location, const uint8_t charmap[8]);
+
+  // Если очередь полна — ждёт (совместимость с Print). UI перед записью
+  // смотрит txFree() и не ждёт никогда.
+  size_t write(uint8_t b) override;
+  using Print::write;
+
+  uint8_t txFree() const;   // свободно в очереди, байт LCD
+  bool busy() const;        // очередь не пуста или идёт передача (после NACK — перезапуск)
+  void flush();             // дождаться, пока всё уйдёт
+
+  uint32_t commandCount() const;  // команд HD44780 с включения (диагностика)
+
+private:
+  void command(uint8_t c);
+  uint8_t _cols, _rows;
+};
@@ -1,8 +1,12 @@
 #include <Arduino.h>
+#include "config.h"
 #include "menu.h"
 #include "ui_text_en.h"
 #include "ui_text_ua.h"
 #include "settings.h"
+#include "totalizer.h"
+#include "input.h"
+#include "fixed.h"
 #include <avr/pgmspace.h>
 #include <string.h>
 
@@ -13,7 +17,7 @@ static void menuStrFromProgmem(char* buf, size_t bufSize, const Settings &s, con
   buf[bufSize - 1] = '\0';
 }
 
-static constexpr uint8_t ITEM_COUNT = 19; // ✅ було 18
+static constexpr uint8_t ITEM_COUNT = MI_COUNT;
 
 static int32_t clampI32(int32_t v, int32_t lo, int32_t hi) { return (v < lo) ? lo : (v > hi) ? hi : v; }
 
@@ -24,26 +28,6 @@ void menuReset(MenuState &m) {
 
 // 19 символів тексту + '\0' (бо out[0] = маркер)
 static void pad19(char out19[20], const char* s) {
-  // Convert UTF-8 to ASCII if needed
-  char converted[64];
-  bool hasUtf8 = false;
-  for (uint8_t k = 0; k < 64 && s[k] != '\0'; k++) {
-    if ((uint8_t)s[k] >= 0xC0) {
-      hasUtf8 = true;
-      break;
-    }
-  }
-  
-  if (hasUtf8) {
-    extern void uiConvertUtf8ToAscii(char* dest, const char* src, size_t destSize);
-    uiConvertUtf8ToAscii(converted, s, sizeof(converted));
-    s = converted;
-  } else {
-    strncpy(converted, s, sizeof(converted) - 1);
-    converted[sizeof(converted) - 1] = '\0';
-    s = converted;
-  }
-  
   uint8_t i = 0;
   for (; i < 19 && s[i] != '\0'; i++) out19[i] = s[i];
   for (; i < 19; i++) out19[i] = ' ';
@@ -56,7 +40,7 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
   char tmp[40];
 
   switch (idx) {
-    case 0: {
+    case MI_MATERIAL: {
       char matLabelBuf[32], steelBuf[16], alumBuf[16];
       menuStrFromProgmem(matLabelBuf, sizeof(matLabelBuf), S, UI_STR_MENU_MATERIAL_EN, UI_STR_MENU_MATERIAL_UA);
       menuStrFromProgmem(steelBuf, sizeof(steelBuf), S, UI_STR_STEEL_EN, UI_STR_STEEL_UA);
@@ -67,7 +51,7 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
-    case 1: {
+    case MI_CUTTER: {
       char cutterLabelBuf[32], mmUnitBuf[8];
       menuStrFromProgmem(cutterLabelBuf, sizeof(cutterLabelBuf), S, UI_STR_MENU_CUTTER_EN, UI_STR_MENU_CUTTER_UA);
       menuStrFromProgmem(mmUnitBuf, sizeof(mmUnitBuf), S, UI_STR_MM_EN, UI_STR_MM_UA);
@@ -75,7 +59,7 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
-    case 2: {
+    case MI_MODE: {
       char modeLabelBuf[32], contBuf[16], pulseBuf[16];
       menuStrFromProgmem(modeLabelBuf, sizeof(modeLabelBuf), S, UI_STR_MENU_MODE_EN, UI_STR_MENU_MODE_UA);
       menuStrFromProgmem(contBuf, sizeof(contBuf), S, UI_STR_CONT_EN, UI_STR_CONT_UA);
@@ -84,7 +68,7 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
-    case 3: {
+    case MI_PULSE_ON: {
       char pulseOnLabelBuf[32], msUnitBuf[8];
       menuStrFromProgmem(pulseOnLabelBuf, sizeof(pulseOnLabelBuf), S, UI_STR_MENU_PULSE_ON_EN, UI_STR_MENU_PULSE_ON_UA);
       menuStrFromProgmem(msUnitBuf, sizeof(msUnitBuf), S, UI_STR_MS_EN, UI_STR_MS_UA);
@@ -92,7 +76,7 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
-    case 4: {
+    case MI_PULSE_OFF: {
       char pulseOffLabelBuf[32], msUnitBuf[8];
       menuStrFromProgmem(pulseOffLabelBuf, sizeof(pulseOffLabelBuf), S, UI_STR_MENU_PULSE_OFF_EN, UI_STR_MENU_PULSE_OFF_UA);
       menuStrFromProgmem(msUnitBuf, sizeof(msUnitBuf), S, UI_STR_MS_EN, UI_STR_MS_UA);
@@ -100,71 +84,96 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
-    case 5: {
+    case MI_PULSE_AVG: {
+      char pulseAvgLabelBuf[32], onOffBuf[8];
+      menuStrFromProgmem(pulseAvgLabelBuf, sizeof(pulseAvgLabelBuf), S, UI_STR_MENU_PULSE_AVG_EN, UI_STR_MENU_PULSE_AVG_UA);
+      if (S.pulse_keep_avg) menuStrFromProgmem(onOffBuf, sizeof(onOffBuf), S, UI_STR_RUN_ON_EN, UI_STR_RUN_ON_UA);
+      else                  menuStrFromProgmem(onOffBuf, sizeof(onOffBuf), S, UI_STR_RUN_OFF_EN, UI_STR_RUN_OFF_UA);
+      snprintf(tmp, sizeof(tmp), "%s %s", pulseAvgLabelBuf, onOffBuf);
+      break;
+    }
+
+    case MI_KMIN: {
       uint16_t v = S.kmin_x100;
       char kminLabelBuf[32];
       menuStrFromProgmem(kminLabelBuf, sizeof(kminLabelBuf), S, UI_STR_MENU_KMIN_EN, UI_STR_MENU_KMIN_UA);
-      snprintf(tmp, sizeof(tmp), "%s %u.%02u",
-               kminLabelBuf,
-               (unsigned)(v / 100), (unsigned)(v % 100));
+      char num[FIXED_FMT_BUF];
+      Kx100::fromRaw(v).format(num);
+      snprintf(tmp, sizeof(tmp), "%s %s", kminLabelBuf, num);
     } break;
 
-    case 6: {
+    case MI_KMAX: {
       uint16_t v = S.kmax_x100;
       char kmaxLabelBuf[32];
       menuStrFromProgmem(kmaxLabelBuf, sizeof(kmaxLabelBuf), S, UI_STR_MENU_KMAX_EN, UI_STR_MENU_KMAX_UA);
-      snprintf(tmp, sizeof(tmp), "%s %u.%02u",
-               kmaxLabelBuf,
-               (unsigned)(v / 100), (unsigned)(v % 100));
+      char num[FIXED_FMT_BUF];
+      Kx100::fromRaw(v).format(num);
+      snprintf(tmp, sizeof(tmp), "%s %s", kmaxLabelBuf, num);
     } break;
 
-    case 7: {
+    case MI_ALFACTOR: {
       uint16_t v = S.al_factor_x100;
       char alFactorLabelBuf[32];
       menuStrFromProgmem(alFactorLabelBuf, sizeof(alFactorLabelBuf), S, UI_STR_MENU_ALFACTOR_EN, UI_STR_MENU_ALFACTOR_UA);
-      snprintf(tmp, sizeof(tmp), "%s %u.%02u",
-               alFactorLabelBuf,
-               (unsigned)(v / 100), (unsigned)(v % 100));
+      char num[FIXED_FMT_BUF];
+      Kx100::fromRaw(v).format(num);
+      snprintf(tmp, sizeof(tmp), "%s %s", alFactorLabelBuf, num);
     } break;
 
-    case 8: {
+    case MI_POT_AVG: {
       char potAvgLabelBuf[32];
       menuStrFromProgmem(potAvgLabelBuf, sizeof(potAvgLabelBuf), S, UI_STR_MENU_POT_AVG_EN, UI_STR_MENU_POT_AVG_UA);
       snprintf(tmp, sizeof(tmp), "%s %u", potAvgLabelBuf, (unsigned)S.pot_avg_N);
       break;
     }
 
-    case 9: {
+    case MI_POT_HYST: {
       uint16_t v = S.pot_hyst_x100;
       char potHystLabelBuf[32];
       menuStrFromProgmem(potHystLabelBuf, sizeof(potHystLabelBuf), S, UI_STR_MENU_POT_HYST_EN, UI_STR_MENU_POT_HYST_UA);
-      snprintf(tmp, sizeof(tmp), "%s %u.%02u",
-               potHystLabelBuf,
-               (unsigned)(v / 100), (unsigned)(v % 100));
+      char num[FIXED_FMT_BUF];
+      Kx100::fromRaw(v).format(num);
+      snprintf(tmp, sizeof(tmp), "%s %s", potHystLabelBuf, num);
     } break;
 
-    case 10: {
+    case MI_PUMPGAIN: {
       char pumpGainLabelBuf[32];
       menuStrFromProgmem(pumpGainLabelBuf, sizeof(pumpGainLabelBuf), S, UI_STR_MENU_PUMPGAIN_EN, UI_STR_MENU_PUMPGAIN_UA);
       snprintf(tmp, sizeof(tmp), "%s %lu", pumpGainLabelBuf, (unsigned long)S.pump_gain_steps_per_u_min);
       break;
     }
 
-    case 11: {
+    case MI_ACCEL:
+    case MI_DECEL: {
+      char rampLabelBuf[32];
+      uint32_t v = (idx == MI_ACCEL) ? S.accel_steps_s2 : S.decel_steps_s2;
+      if (idx == MI_ACCEL) menuStrFromProgmem(rampLabelBuf, sizeof(rampLabelBuf), S, UI_STR_MENU_ACCEL_EN, UI_STR_MENU_ACCEL_UA);
+      else                 menuStrFromProgmem(rampLabelBuf, sizeof(rampLabelBuf), S, UI_STR_MENU_DECEL_EN, UI_STR_MENU_DECEL_UA);
+      if (v == 0) {
+        char offBuf[16];
+        menuStrFromProgmem(offBuf, sizeof(offBuf), S, UI_STR_RUN_OFF_EN, UI_STR_RUN_OFF_UA);
+        snprintf(tmp, sizeof(tmp), "%s %s", rampLabelBuf, offBuf);
+      } else {
+        snprintf(tmp, sizeof(tmp), "%s %lu", rampLabelBuf, (unsigned long)v);
+      }
+      break;
+    }
+
+    case MI_CAL_60: {
       char cal60LabelBuf[32];
       menuStrFromProgmem(cal60LabelBuf, sizeof(cal60LabelBuf), S, UI_STR_MENU_CAL_60_EN, UI_STR_MENU_CAL_60_UA);
       snprintf(tmp, sizeof(tmp), "%s", cal60LabelBuf);
       break;
     }
 
-    case 12: {
+    case MI_CAL_120: {
       char cal120LabelBuf[32];
       menuStrFromProgmem(cal120LabelBuf, sizeof(cal120LabelBuf), S, UI_STR_MENU_CAL_120_EN, UI_STR_MENU_CAL_120_UA);
       snprintf(tmp, sizeof(tmp), "%s", cal120LabelBuf);
       break;
     }
 
-    case 13: {
+    case MI_CAL_MLU: {
       char calMlULabelBuf[32];
       menuStrFromProgmem(calMlULabelBuf, sizeof(calMlULabelBuf), S, UI_STR_MENU_CAL_MLU_EN, UI_STR_MENU_CAL_MLU_UA);
       if (!S.calibrated) {
@@ -172,38 +181,48 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
         menuStrFromProgmem(noneBuf, sizeof(noneBuf), S, UI_STR_MENU_CAL_NONE_EN, UI_STR_MENU_CAL_NONE_UA);
         snprintf(tmp, sizeof(tmp), "%s %s", calMlULabelBuf, noneBuf);
       } else {
-        uint32_t x = S.ml_per_u_x1000;
-        uint32_t w = x / 1000;
-        uint32_t f = (x % 1000) / 10; // 2 decimals
-        snprintf(tmp, sizeof(tmp), "%s %lu.%02lu",
-                 calMlULabelBuf,
-                 (unsigned long)w, (unsigned long)f);
+        char num[FIXED_FMT_BUF];
+        Fx1000::fromRaw(S.ml_per_u_x1000).format(num, 2);   // 2 знака, остальное отбрасывается
+        snprintf(tmp, sizeof(tmp), "%s %s", calMlULabelBuf, num);
       }
       break;
     }
 
-    case 14: {
+    case MI_CLEAR_CAL: {
       char clearCalLabelBuf[32];
       menuStrFromProgmem(clearCalLabelBuf, sizeof(clearCalLabelBuf), S, UI_STR_MENU_CLEAR_CAL_EN, UI_STR_MENU_CLEAR_CAL_UA);
       snprintf(tmp, sizeof(tmp), "%s", clearCalLabelBuf);
       break;
     }
 
-    case 15: {
+    case MI_OIL_TOTAL: {
+      char oilLabelBuf[32], lUnitBuf[8];
+      menuStrFromProgmem(oilLabelBuf, sizeof(oilLabelBuf), S, UI_STR_MENU_OIL_TOTAL_EN, UI_STR_MENU_OIL_TOTAL_UA);
+      menuStrFromProgmem(lUnitBuf, sizeof(lUnitBuf), S, UI_STR_L_EN, UI_STR_L_UA);
+      // мл x100 -> целые мл = литры x1000
+      uint32_t ml = Fixed<100, uint32_t>::fromRaw(totalizerLifetimeMl_x100()).rescale<1>().raw;
+      char num[FIXED_FMT_BUF];
+      Fx1000::fromRaw(ml).format(num);
+      snprintf(tmp, sizeof(tmp), "%s %s%s", oilLabelBuf, num, lUnitBuf);
+      break;
+    }
+
+    case MI_SAVE: {
       char saveLabelBuf[32];
       menuStrFromProgmem(saveLabelBuf, sizeof(saveLabelBuf), S, UI_STR_MENU_SAVE_EN, UI_STR_MENU_SAVE_UA);
-      snprintf(tmp, sizeof(tmp), "%s", saveLabelBuf);
+      // "..." пока запись ещё идёт в фоне
+      snprintf(tmp, sizeof(tmp), "%s%s", saveLabelBuf, settingsSavePending() ? "..." : "");
       break;
     }
 
-    case 16: {
+    case MI_DEFAULTS: {
       char defaultsLabelBuf[32];
       menuStrFromProgmem(defaultsLabelBuf, sizeof(defaultsLabelBuf), S, UI_STR_MENU_DEFAULTS_EN, UI_STR_MENU_DEFAULTS_UA);
       snprintf(tmp, sizeof(tmp), "%s", defaultsLabelBuf);
       break;
     }
 
-    case 17: {
+    case MI_LANGUAGE: {
       char langLabelBuf[32], langEnBuf[16], langUaBuf[16];
       menuStrFromProgmem(langLabelBuf, sizeof(langLabelBuf), S, UI_STR_MENU_LANGUAGE_EN, UI_STR_MENU_LANGUAGE_UA);
       menuStrFromProgmem(langEnBuf, sizeof(langEnBuf), S, UI_STR_MENU_LANG_EN_EN, UI_STR_MENU_LANG_EN_UA);
@@ -212,7 +231,7 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
-    case 18: {
+    case MI_LCD_TEST: {
       char lcdTestLabelBuf[32];
       menuStrFromProgmem(lcdTestLabelBuf, sizeof(lcdTestLabelBuf), S, UI_STR_MENU_LCD_TEST_EN, UI_STR_MENU_LCD_TEST_UA);
       snprintf(tmp, sizeof(tmp), "%s", lcdTestLabelBuf);
@@ -221,6 +240,15 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
       break;
     }
 
+#if PROF_ENABLE
+    case MI_DIAG: {
+      char diagLabelBuf[32];
+      menuStrFromProgmem(diagLabelBuf, sizeof(diagLabelBuf), S, UI_STR_MENU_DIAG_EN, UI_STR_MENU_DIAG_UA);
+      snprintf(tmp, sizeof(tmp), "%s", diagLabelBuf);
+      break;
+    }
+#endif
+
     default:
       snprintf(tmp, sizeof(tmp), "-");
       break;
@@ -232,7 +260,13 @@ static void makeItemLine(char out[21], uint8_t idx, char lead, const Settings &S
   out[20] = '\0';
 }
 
-MenuAction menuOnDelta(MenuState &m, int8_t step, Settings &S) {
+// Числовое поле: шаг base, с ускорением энкодера, в пределах lo..hi
+template <typename T>
+static void editNum(T &v, int8_t step, uint8_t accel, int32_t base, int32_t lo, int32_t hi) {
+  v = (T)clampI32((int32_t)v + encAccelDelta(step, accel, base, hi - lo), lo, hi);
+}
+
+MenuAction menuOnDelta(MenuState &m, int8_t step, uint8_t accel, Settings &S) {
   if (step == 0) return MENU_ACT_NONE;
 
   if (!m.editing) {
@@ -244,39 +278,43 @@ MenuAction menuOnDelta(MenuState &m, int8_t step, Settings &S) {
   }
 
   switch (m.index) {
-    case 0:
+    case MI_MATERIAL:
       S.material = (step > 0) ? MAT_ALUMINUM : MAT_STEEL;
       return MENU_ACT_RECOMPUTE;
 
-    case 1:
-      S.cutter_mm = (uint8_t)clampI32((int32_t)S.cutter_mm + step, 3, 50);
+    case MI_CUTTER:
+      editNum(S.cutter_mm, step, accel, 1, 3, 50);
       return MENU_ACT_RECOMPUTE;
 
-    case 2:
+    case MI_MODE:
       S.mode = (S.mode == MODE_CONT) ? MODE_PULSE : MODE_CONT;
       return MENU_ACT_NONE;
 
-    case 3:
-      S.pulse_on_ms = (uint16_t)clampI32((int32_t)S.pulse_on_ms + step * 50, 100, 5000);
+    case MI_PULSE_ON:
+      editNum(S.pulse_on_ms, step, accel, 50, 100, 5000);
       return MENU_ACT_NONE;
 
-    case 4:
-      S.pulse_off_ms = (uint16_t)clampI32((int32_t)S.pulse_off_ms + step * 100, 100, 10000);
+    case MI_PULSE_OFF:
+      editNum(S.pulse_off_ms, step, accel, 100, 100, 10000);
       return MENU_ACT_NONE;
 
-    case 5:
-      S.kmin_x100 = (uint16_t)clampI32((int32_t)S.kmin_x100 + step * 2, 20, 100);
+    case MI_PULSE_AVG:
+      S.pulse_keep_avg = S.pulse_keep_avg ? 0 : 1;
+      return MENU_ACT_NONE;
+
+    case MI_KMIN:
+      editNum(S.kmin_x100, step, accel, 2, 20, 100);
       return MENU_ACT_RECOMPUTE;
 
-    case 6:
-      S.kmax_x100 = (uint16_t)clampI32((int32_t)S.kmax_x100 + step * 5, 120, 400);
+    case MI_KMAX:
+      editNum(S.kmax_x100, step, accel, 5, 120, 400);
       return MENU_ACT_RECOMPUTE;
 
-    case 7:
-      S.al_factor_x100 = (uint16_t)clampI32((int32_t)S.al_factor_x100 + step * 2, 100, 200);
+    case MI_ALFACTOR:
+      editNum(S.al_factor_x100, step, accel, 2, 100, 200);
       return MENU_ACT_RECOMPUTE;
 
-    case 8: {
+    case MI_POT_AVG: {
       uint8_t n = S.pot_avg_N;
       if (step > 0) { if (n == 4) n = 8; else if (n == 8) n = 16; }
       else          { if (n == 16) n = 8; else if (n == 8) n = 4; }
@@ -284,19 +322,23 @@ MenuAction menuOnDelta(MenuState &m, int8_t step, Settings &S) {
       return MENU_ACT_NONE;
     }
 
-    case 9:
-      S.pot_hyst_x100 = (uint8_t)clampI32((int32_t)S.pot_hyst_x100 + step, 0, 50);
+    case MI_POT_HYST:
+      editNum(S.pot_hyst_x100, step, accel, 1, 0, 50);
       return MENU_ACT_NONE;
 
-    case 10: {
-      int32_t g = (int32_t)S.pump_gain_steps_per_u_min;
-      g += step * 50;
-      g = clampI32(g, 50, 50000);
-      S.pump_gain_steps_per_u_min = (uint32_t)g;
+    case MI_PUMPGAIN:
+      editNum(S.pump_gain_steps_per_u_min, step, accel, 50, 50, 50000);
+      return MENU_ACT_RECOMPUTE;   // таблица POT -> частота строится заново
+
+    case MI_ACCEL:
+    case MI_DECEL: {
+      // шаг/с^2, 0 = без рампы
+      uint32_t &a = (m.index == MI_ACCEL) ? S.accel_steps_s2 : S.decel_steps_s2;
+      editNum(a, step, accel, 1000, 0, 200000);
       return MENU_ACT_NONE;
     }
 
-    case 17:
+    case MI_LANGUAGE:
       S.uiLang = (S.uiLang == UILANG_UA) ? UILANG_EN : UILANG_UA;
       return MENU_ACT_SAVE;
 
@@ -308,15 +350,19 @@ MenuAction menuOnDelta(MenuState &m, int8_t step, Settings &S) {
 MenuAction menuOnClick(MenuState &m, Settings &S) {
   if (!m.editing) {
     // "Action" items (no edit mode)
-    if (m.index == 11) return MENU_ACT_CAL_START_60;
-    if (m.index == 12) return MENU_ACT_CAL_START_120;
-    if (m.index == 14) { m.editing = true; return MENU_ACT_NONE; }
-    if (m.index == 15) return MENU_ACT_SAVE;
-    if (m.index == 16) return MENU_ACT_DEFAULTS;
-    if (m.index == 18) return MENU_ACT_LCD_TEST; // ✅ NEW
+    if (m.index == MI_CAL_60) return MENU_ACT_CAL_START_60;
+    if (m.index == MI_CAL_120) return MENU_ACT_CAL_START_120;
+    if (m.index == MI_CLEAR_CAL) { m.editing = true; return MENU_ACT_NONE; }
+    if (m.index == MI_SAVE) return MENU_ACT_SAVE;
+    if (m.index == MI_DEFAULTS) return MENU_ACT_DEFAULTS;
+    if (m.index == MI_LCD_TEST) return MENU_ACT_LCD_TEST; // ✅ NEW
+#if PROF_ENABLE
+    if (m.index == MI_DIAG) return MENU_ACT_DIAG;
+#endif
 
     // Read-only info item
-    if (m.index == 13) return MENU_ACT_NONE;
+    if (m.index == MI_CAL_MLU) return MENU_ACT_NONE;
+    if (m.index == MI_OIL_TOTAL) return MENU_ACT_NONE;
 
     // Enter edit mode for editable items (including Language)
     m.editing = true;
@@ -324,8 +370,8 @@ MenuAction menuOnClick(MenuState &m, Settings &S) {
   } else {
     // Exit edit mode.
     m.editing = false;
-    if (m.index == 14) return MENU_ACT_CAL_CLEAR; // confirm clear calibration
-    if (m.index == 17) return MENU_ACT_SAVE;      // persist Language
+    if (m.index == MI_CLEAR_CAL) return MENU_ACT_CAL_CLEAR; // confirm clear calibration
+    if (m.index == MI_LANGUAGE) return MENU_ACT_SAVE;      // persist Language
     return MENU_ACT_NONE;
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "config.h"
 #include "types.h"
 
 enum MenuAction : uint8_t {
@@ -11,6 +12,38 @@ enum MenuAction : uint8_t {
   MENU_ACT_CAL_START_120,
   MENU_ACT_CAL_CLEAR,
   MENU_ACT_LCD_TEST,     // ✅ NEW
+  MENU_ACT_DIAG,         // экран профайлера (PROF_ENABLE)
+};
+
+// Пункты меню (порядок = порядок на экране)
+enum MenuItem : uint8_t {
+  MI_MATERIAL,
+  MI_CUTTER,
+  MI_MODE,
+  MI_PULSE_ON,
+  MI_PULSE_OFF,
+  MI_PULSE_AVG,
+  MI_KMIN,
+  MI_KMAX,
+  MI_ALFACTOR,
+  MI_POT_AVG,
+  MI_POT_HYST,
+  MI_PUMPGAIN,
+  MI_ACCEL,
+  MI_DECEL,
+  MI_CAL_60,
+  MI_CAL_120,
+  MI_CAL_MLU,
+  MI_CLEAR_CAL,
+  MI_OIL_TOTAL,
+  MI_SAVE,
+  MI_DEFAULTS,
+  MI_LANGUAGE,
+  MI_LCD_TEST,
+#if PROF_ENABLE
+  MI_DIAG,
+#endif
+  MI_COUNT
 };
 
 struct MenuState {
@@ -20,7 +53,7 @@ struct MenuState {
 
 void menuReset(MenuState &m);
 
-MenuAction menuOnDelta(MenuState &m, int8_t step, Settings &S);
+MenuAction menuOnDelta(MenuState &m, int8_t step, uint8_t accel, Settings &S);
 MenuAction menuOnClick(MenuState &m, Settings &S);
 
 void menuRender3(const MenuState &m, const Settings &S,
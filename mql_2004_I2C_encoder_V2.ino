@@ -4,11 +4,17 @@
 #include "types.h"
 #include "settings.h"
 #include "input.h"
+#include "pot.h"
+#include "pot_filter.h"
 #include "reco.h"
 #include "pump.h"
+#include "totalizer.h"
 #include "ui.h"
 #include "menu.h"
 #include "ui_print.h"
+#include "sched.h"
+#include "prof.h"
+#include "fixed.h"
 
 #include "lcd_test.h"   // ✅ NEW
 
@@ -23,27 +29,29 @@ static int32_t potMin_x100 = 27;
 static int32_t potMax_x100 = 110;
 static int32_t set_x100 = 55;
 
+// Эпоха диапазона: +1 при каждом пересчёте potMin/potMax/gain. Кэши,
+// построенные под диапазон (таблица POT -> частота), сверяют её с своей.
+// 16 бит: каждый щелчок энкодера в меню — пересчёт, 8-битная эпоха
+// за сеанс настройки могла обернуться и совпасть со старой таблицей
+static uint16_t rangeEpoch = 0;
+
 static bool pulseOn = true;
 static uint32_t pulseMs = 0;
 
-// HARD START (direct pin)
-static bool     startRawPrev = false;
-static uint32_t startRawLastMs = 0;
-
-// HARD DIA ACCEL (direct UP/DOWN only in ST_WIZ_DIA)
-static bool     upPrev = false, dnPrev = false;
-static uint32_t upPressMs = 0, dnPressMs = 0;
-static uint32_t upLastRptMs = 0, dnLastRptMs = 0;
-
 // Calibration
 static const int32_t CAL_FLOW_U_X100 = 100; // 1.00 u/min
 static uint16_t calTotalSec = 60;
 static uint32_t calStartMs = 0;
 static uint32_t calDurationMs = 60000UL;
+static uint32_t calStartSteps = 0;     // счётчик шагов на старте калибровки
 
 static int32_t calMeasuredMl_x100 = 0; // 0..9999 (0.00..99.99 ml)
 static uint8_t calDigitIdx = 0;        // 0..3 (tens, ones, tenths, hundredths)
 
+#if PROF_ENABLE
+static uint8_t diagPage = 0;           // ProfId на экране DIAG
+#endif
+
 // ===== MENU EDIT BACKUP (для CANCEL) =====
 static Settings _menuBackup;
 static bool     _menuBackupValid = false;
@@ -53,34 +61,49 @@ static int32_t clampI32(int32_t v, int32_t lo, int32_t hi) { return (v < lo) ? l
 
 static int32_t potMap(uint16_t adc, int32_t mn, int32_t mx) {
   if (mx < mn) mx = mn;
-  int32_t span = mx - mn;
-  return mn + (int32_t)(((int64_t)span * adc) / 1023);
+  // span * 4092 влезает в 32 бита, пока диапазон меньше 10000.00 u/min
+  uint32_t span = (uint32_t)(mx - mn);
+  return mn + (int32_t)(span * adc / POT_ADC_MAX);
 }
 
 static void recomputeRecAndRange() {
   rec_x100 = recoGetRecFlow_x100(S.material, S.cutter_mm, S.al_factor_x100);
   S.last_rec_x100 = rec_x100;
 
-  potMin_x100 = (int32_t)((int64_t)rec_x100 * S.kmin_x100 / 100);
-  potMax_x100 = (int32_t)((int64_t)rec_x100 * S.kmax_x100 / 100);
+  Fx100 rec = Fx100::fromRaw(rec_x100);
+  potMin_x100 = rec.mul(Kx100::fromRaw(S.kmin_x100)).raw;
+  potMax_x100 = rec.mul(Kx100::fromRaw(S.kmax_x100)).raw;
   if (potMax_x100 < potMin_x100 + 10) potMax_x100 = potMin_x100 + 10;
+  rangeEpoch++;
+
+  set_x100 = potMap(potFilterOut(), potMin_x100, potMax_x100);
+}
 
-  set_x100 = potMap(potGetAvgAdc(), potMin_x100, potMax_x100);
+// Мёртвая зона фильтра POT: pot_hyst_x100 (u/min) в отсчётах АЦП на
+// текущем диапазоне potMin..potMax
+static uint16_t potDeadbandAdc() {
+  int32_t span = potMax_x100 - potMin_x100;
+  if (span <= 0) return 0;
+  uint32_t d = (uint32_t)S.pot_hyst_x100 * POT_ADC_MAX / (uint32_t)span;
+  return (d > POT_ADC_MAX) ? POT_ADC_MAX : (uint16_t)d;
 }
 
 static void startRun() {
   pulseOn = true;
   pulseMs = millis();
   digitalWrite(PIN_START_LED, HIGH);
+  pumpSetRamp(S.accel_steps_s2, S.decel_steps_s2);
   pumpSetEnable(true);
+  totalizerJobStart();
   state = ST_RUN;
   uiClear();
-  uiDrawRun(S, rec_x100, set_x100, true);
+  uiDrawRun(S, rec_x100, set_x100, true, totalizerJobMl_x100(S));
 }
 
 static void stopRunToReady() {
   digitalWrite(PIN_START_LED, LOW);
   pumpStop();
+  totalizerJobStop();
   state = ST_READY;
   uiClear();
   uiDrawReady(S);
@@ -91,6 +114,7 @@ static void enterMenu() {
   if (state == ST_RUN || state == ST_CAL_RUN) {
     digitalWrite(PIN_START_LED, LOW);
     pumpStop();
+    totalizerJobStop();
   }
   state = ST_MENU;
   menuReset(menu);
@@ -102,11 +126,17 @@ static void enterWizardSafe() {
   if (state == ST_RUN || state == ST_CAL_RUN) {
     digitalWrite(PIN_START_LED, LOW);
     pumpStop();
+    totalizerJobStop();
   }
   state = ST_WIZ_MAT;
   uiClear();
 }
 
+static uint16_t calSecondsLeft() {
+  uint32_t elapsed = millis() - calStartMs;
+  return (elapsed >= calDurationMs) ? 0 : (uint16_t)((calDurationMs - elapsed) / 1000UL);
+}
+
 static void stopCalibrationPump() {
   digitalWrite(PIN_START_LED, LOW);
   pumpStop();
@@ -119,8 +149,10 @@ static void startCalibration(uint16_t sec) {
 
   calMeasuredMl_x100 = 0;
   calDigitIdx = 0;
+  calStartSteps = pumpGetStepCount();
 
   digitalWrite(PIN_START_LED, HIGH);
+  pumpSetRamp(S.accel_steps_s2, S.decel_steps_s2);
   pumpSetEnable(true);
   pumpRunCont(CAL_FLOW_U_X100, S.pump_gain_steps_per_u_min);
 
@@ -159,310 +191,279 @@ static int32_t setDigit(int32_t ml_x100, uint8_t idx, uint8_t digit) {
 static void saveCalibrationFromInput() {
   if (calMeasuredMl_x100 <= 0) return;
 
-  uint32_t total_u_x100 = (uint32_t)calTotalSec * 100UL / 60UL;
-  if (total_u_x100 == 0) return;
+  // По реально выданным шагам (вместе с разгоном/торможением), а не по
+  // времени * заданной частоте: 1 u = pump_gain шагов
+  uint32_t steps = pumpGetStepCount() - calStartSteps;
+  if (steps == 0 || S.pump_gain_steps_per_u_min == 0) return;
 
-  uint32_t ml_per_u_x1000 = (uint32_t)calMeasuredMl_x100 * 1000UL / total_u_x100;
-  if (ml_per_u_x1000 == 0) return;
+  uint64_t x = (uint64_t)calMeasuredMl_x100 * 10ULL * S.pump_gain_steps_per_u_min / steps;
+  if (x == 0 || x > 0xFFFFFFFFULL) return;
+  uint32_t ml_per_u_x1000 = (uint32_t)x;
 
   S.calibrated = true;
   S.ml_per_u_x1000 = ml_per_u_x1000;
   settingsSave();
 }
 
-// ---- helper: accelerated diameter steps only in ST_WIZ_DIA
-static int8_t diaAccelStep(bool pressedNow, bool &prev, uint32_t &pressMs, uint32_t &lastRptMs, int8_t dir) {
-  uint32_t now = millis();
-  int8_t out = 0;
-
-  if (pressedNow && !prev) { // press edge
-    pressMs = now;
-    lastRptMs = now;
-    out = dir * 1; // first step always 1mm
-  }
-
-  if (pressedNow) {
-    uint32_t held = now - pressMs;
-
-    int8_t stepSize = 1;
-    if (held >= 1500) stepSize = 10;
-    else if (held >= 600) stepSize = 5;
+// ===================== ЗАДАЧИ =====================
+// Всё, что делает loop(), разложено по задачам планировщика (sched.h);
+// таблица — внизу, перед setup()
 
-    uint16_t interval;
-    if      (held < 300)  interval = 180;
-    else if (held < 900)  interval = 120;
-    else if (held < 1600) interval = 80;
-    else                  interval = 55;
+// ---- ввод: энкодер/кнопки -> автомат состояний
+static void taskInput() {
+  PROF_SCOPE(PROF_INPUT);
+  InputEvents ev;
+  inputPoll(ev);
 
-    if ((now - lastRptMs) >= interval) {
-      lastRptMs = now;
-      out += (int8_t)(dir * stepSize);
-    }
+  if (ev.encStep || ev.encClick || ev.encLong || ev.menuClick || ev.startClick) {
+    uiInvalidate();
   }
 
-  prev = pressedNow;
-  return out;
-}
-
-void setup() {
-  Serial.begin(9600);  // для отладки
-
-  settingsLoad();
-  uiBegin();
-  inputBegin();
-  potSetFilterN(S.pot_avg_N);
-
-  pumpBegin();
-
-  pinMode(PIN_START_LED, OUTPUT);
-  digitalWrite(PIN_START_LED, LOW);
-
-  (void)potGetAvgAdc();
-  recomputeRecAndRange();
-  uiDrawReady(S);
-
-  // HARD START init
-  startRawPrev = (digitalRead(PIN_START_BTN) == LOW);
-  startRawLastMs = millis();
-
-  // HARD DIA init
-  upPrev = (digitalRead(PIN_BTN_UP) == LOW);
-  dnPrev = (digitalRead(PIN_BTN_DOWN) == LOW);
-  upPressMs = dnPressMs = millis();
-  upLastRptMs = dnLastRptMs = millis();
-}
+  // ✅ LCD TEST overlay: перехоплення кнопок/енкодера і вихід по OK/MENU
+  if (lcdTestIsActive()) {
+    if (ev.encStep)   lcdTestOnEnc(ev.encStep);
+    if (ev.encClick)  lcdTestOnOk();
+    if (ev.menuClick) lcdTestOnMenu();
 
-void loop() {
-  static uint32_t tPoll = 0;
-  static uint32_t tUi = 0;
-  static uint8_t lastPotN = 0;
+    // поки тест активний — нічого не чіпаємо
+    if (lcdTestIsActive()) {
+      // START у тесті ігноруємо
+      return;
+    }
 
-  if (S.pot_avg_N != lastPotN) {
-    lastPotN = S.pot_avg_N;
-    potSetFilterN(S.pot_avg_N);
+    // вийшли з тесту -> очистити, і хай UI перемалює меню/екран
+    uiClear();
+    return;
   }
 
-  if (millis() - tPoll >= INPUT_POLL_MS) {
-    tPoll = millis();
-
-    InputEvents ev;
-    inputPoll(ev);
-
-    // HARD START override (direct pin)
-    {
-      bool sNow = (digitalRead(PIN_START_BTN) == LOW);
-      if (sNow && !startRawPrev) {
-        if ((uint16_t)(millis() - startRawLastMs) >= 60) {
-          ev.startClick = true;
-          startRawLastMs = millis();
-        }
-      }
-      startRawPrev = sNow;
+#if PROF_ENABLE
+  // DIAG: энкодер листает участки, любая кнопка — назад в меню
+  if (state == ST_DIAG) {
+    if (ev.encStep > 0) diagPage = (uint8_t)((diagPage + 1) % PROF_COUNT);
+    else if (ev.encStep < 0) diagPage = (uint8_t)((diagPage + PROF_COUNT - 1) % PROF_COUNT);
+    if (ev.encClick || ev.menuClick || ev.startClick) {
+      state = ST_MENU;
+      uiClear();
     }
-
-    // HARD DIA accel override (only in ST_WIZ_DIA)
-    if (state == ST_WIZ_DIA) {
-      // ignore ev.encStep from input.cpp here
-      ev.encStep = 0;
-
-      bool upNow = (digitalRead(PIN_BTN_UP) == LOW);
-      bool dnNow = (digitalRead(PIN_BTN_DOWN) == LOW);
-
-      ev.encStep += diaAccelStep(upNow, upPrev, upPressMs, upLastRptMs, +1);
-      ev.encStep += diaAccelStep(dnNow, dnPrev, dnPressMs, dnLastRptMs, -1);
-    } else {
-      // keep prev states updated so first accel press is correct when enter ST_WIZ_DIA
-      upPrev = (digitalRead(PIN_BTN_UP) == LOW);
-      dnPrev = (digitalRead(PIN_BTN_DOWN) == LOW);
+    return;
+  }
+#endif
+
+  // UP/DOWN
+  if (ev.encStep != 0) {
+    if (state == ST_WIZ_MAT) {
+      S.material = (S.material == MAT_STEEL) ? MAT_ALUMINUM : MAT_STEEL;
+      recomputeRecAndRange();
+    } else if (state == ST_WIZ_DIA) {
+      // ускорение энкодера: быстро крутишь — мм идут пачкой
+      S.cutter_mm = (uint8_t)clampI32((int32_t)S.cutter_mm + encAccelDelta(ev.encStep, ev.encAccel, 1, 50 - 3), 3, 50);
+      recomputeRecAndRange();
+    } else if (state == ST_MENU) {
+      MenuAction act = menuOnDelta(menu, ev.encStep, ev.encAccel, S);
+      if (act == MENU_ACT_RECOMPUTE) recomputeRecAndRange();
+    } else if (state == ST_CAL_INPUT) {
+      uint8_t d = getDigit(calMeasuredMl_x100, calDigitIdx);
+      if (ev.encStep > 0) d = (uint8_t)((d + 1) % 10);
+      else                d = (uint8_t)((d + 9) % 10);
+      calMeasuredMl_x100 = setDigit(calMeasuredMl_x100, calDigitIdx, d);
     }
+  }
 
-    // ✅ LCD TEST overlay: перехоплення кнопок/енкодера і вихід по OK/MENU
-    if (lcdTestIsActive()) {
-      if (ev.encStep)   lcdTestOnEnc(ev.encStep);
-      if (ev.encClick)  lcdTestOnOk();
-      if (ev.menuClick) lcdTestOnMenu();
-
-      // поки тест активний — нічого не чіпаємо
-      if (lcdTestIsActive()) {
-        // START у тесті ігноруємо
-        goto _afterPollBlock;
+  // OK short
+  if (ev.encClick) {
+    if (state == ST_READY) {
+      // ✅ READY: коротке OK відкриває MENU
+      enterMenu();
+    } else if (state == ST_WIZ_MAT) {
+      state = ST_WIZ_DIA;
+      uiClear();
+    } else if (state == ST_WIZ_DIA) {
+      recomputeRecAndRange();
+      state = ST_WIZ_REC;
+      uiClear();
+    } else if (state == ST_MENU) {
+      bool wasEditing = menu.editing;
+      if (!wasEditing) {
+        _menuBackup = S;
+        _menuBackupValid = true;
       }
 
-      // вийшли з тесту -> очистити, і хай UI перемалює меню/екран
-      uiClear();
-      goto _afterPollBlock;
-    }
+      MenuAction act = menuOnClick(menu, S);
 
-    // POT only in WIZ_REC / RUN
-    if (state == ST_WIZ_REC || state == ST_RUN) {
-      int32_t newSet = potMap(potGetAvgAdc(), potMin_x100, potMax_x100);
-      int32_t diff = newSet - set_x100; if (diff < 0) diff = -diff;
-      if (diff >= (int32_t)S.pot_hyst_x100) set_x100 = newSet;
-    }
+      if (!menu.editing) _menuBackupValid = false;
+      if (wasEditing && !menu.editing) _menuBackupValid = false;
 
-    // UP/DOWN
-    if (ev.encStep != 0) {
-      if (state == ST_WIZ_MAT) {
-        S.material = (S.material == MAT_STEEL) ? MAT_ALUMINUM : MAT_STEEL;
-        recomputeRecAndRange();
-      } else if (state == ST_WIZ_DIA) {
-        S.cutter_mm = (uint8_t)clampI32((int32_t)S.cutter_mm + ev.encStep, 3, 50);
-        recomputeRecAndRange();
-      } else if (state == ST_MENU) {
-        MenuAction act = menuOnDelta(menu, ev.encStep, S);
-        if (act == MENU_ACT_RECOMPUTE) recomputeRecAndRange();
-      } else if (state == ST_CAL_INPUT) {
-        uint8_t d = getDigit(calMeasuredMl_x100, calDigitIdx);
-        if (ev.encStep > 0) d = (uint8_t)((d + 1) % 10);
-        else                d = (uint8_t)((d + 9) % 10);
-        calMeasuredMl_x100 = setDigit(calMeasuredMl_x100, calDigitIdx, d);
-      }
-    }
-
-    // OK short
-    if (ev.encClick) {
-      if (state == ST_READY) {
-        // ✅ READY: коротке OK відкриває MENU
-        enterMenu();
-      } else if (state == ST_WIZ_MAT) {
-        state = ST_WIZ_DIA;
-        uiClear();
-      } else if (state == ST_WIZ_DIA) {
-        recomputeRecAndRange();
-        state = ST_WIZ_REC;
+      // ✅ NEW: LCD TEST start
+      if (act == MENU_ACT_LCD_TEST) {
+        // стартуємо поверх меню, state лишаємо ST_MENU
         uiClear();
-      } else if (state == ST_MENU) {
-        bool wasEditing = menu.editing;
-        if (!wasEditing) {
-          _menuBackup = S;
-          _menuBackupValid = true;
-        }
-
-        MenuAction act = menuOnClick(menu, S);
-
-        if (!menu.editing) _menuBackupValid = false;
-        if (wasEditing && !menu.editing) _menuBackupValid = false;
-
-        // ✅ NEW: LCD TEST start
-        if (act == MENU_ACT_LCD_TEST) {
-          // стартуємо поверх меню, state лишаємо ST_MENU
-          uiClear();
-          lcdTestEnter(0x20); // 0x20..  (якщо хочеш A0.. -> постав 0xA0)
-          goto _afterPollBlock;
-        }
-
-        if (act == MENU_ACT_SAVE) {
-          settingsSave();
-        } else if (act == MENU_ACT_DEFAULTS) {
-          settingsLoadDefaults();
-          settingsSave();
-          potSetFilterN(S.pot_avg_N);
-          recomputeRecAndRange();
-        } else if (act == MENU_ACT_RECOMPUTE) {
-          recomputeRecAndRange();
-        } else if (act == MENU_ACT_CAL_START_60) {
-          startCalibration(60);
-        } else if (act == MENU_ACT_CAL_START_120) {
-          startCalibration(120);
-        } else if (act == MENU_ACT_CAL_CLEAR) {
-          S.calibrated = false;
-          S.ml_per_u_x1000 = 0;
-          settingsSave();
-        }
-      } else if (state == ST_CAL_INPUT) {
-        if (calDigitIdx < 3) calDigitIdx++;
-        else {
-          saveCalibrationFromInput();
-          state = ST_MENU;
-          menuReset(menu);
-          _menuBackupValid = false;
-          uiClear();
-        }
+        lcdTestEnter(0x20); // 0x20..  (якщо хочеш A0.. -> постав 0xA0)
+        return;
       }
-    }
-
-    // MENU/BACK (hold)
-    if (ev.menuClick) {
 
-      // ✅ READY: довге натискання відкриває Wizard
-      if (state == ST_READY) {
-        enterWizardSafe();
+#if PROF_ENABLE
+      if (act == MENU_ACT_DIAG) {
+        state = ST_DIAG;
+        uiClear();
+        return;
       }
-      // CANCEL in MENU editing
-      else if (state == ST_MENU && menu.editing) {
-        if (_menuBackupValid) {
-          S = _menuBackup;
-        }
-        menu.editing = false;
-        _menuBackupValid = false;
+#endif
+
+      if (act == MENU_ACT_SAVE) {
+        settingsSave();
+      } else if (act == MENU_ACT_DEFAULTS) {
+        settingsLoadDefaults();
+        settingsSave();
+        potSetFilterN(S.pot_avg_N);
         recomputeRecAndRange();
-        uiClear();
+      } else if (act == MENU_ACT_RECOMPUTE) {
+        recomputeRecAndRange();
+      } else if (act == MENU_ACT_CAL_START_60) {
+        startCalibration(60);
+      } else if (act == MENU_ACT_CAL_START_120) {
+        startCalibration(120);
+      } else if (act == MENU_ACT_CAL_CLEAR) {
+        S.calibrated = false;
+        S.ml_per_u_x1000 = 0;
+        settingsSave();
       }
-      // old BACK behavior
-      else if (state == ST_WIZ_REC || state == ST_RUN) {
-        enterMenu();
-      } else if (state == ST_MENU) {
-        state = ST_READY;
-        _menuBackupValid = false;
-        uiClear();
-      } else if (state == ST_CAL_RUN) {
-        stopCalibrationPump();
-        state = ST_MENU;
-        menuReset(menu);
-        _menuBackupValid = false;
-        uiClear();
-      } else if (state == ST_CAL_INPUT) {
+    } else if (state == ST_CAL_INPUT) {
+      if (calDigitIdx < 3) calDigitIdx++;
+      else {
+        saveCalibrationFromInput();
         state = ST_MENU;
         menuReset(menu);
         _menuBackupValid = false;
         uiClear();
       }
     }
+  }
 
-    // START/STOP
-    if (ev.startClick) {
-      if (state == ST_READY) {
-        recomputeRecAndRange();
-        startRun();
-      } else if (state == ST_WIZ_MAT || state == ST_WIZ_DIA) {
-        state = ST_READY;
-        uiClear();
-      } else if (state == ST_WIZ_REC) {
-        wizardDone = true;
-        startRun();
-      } else if (state == ST_RUN) {
-        stopRunToReady();
-      } else if (state == ST_MENU) {
-        state = ST_READY;
-        _menuBackupValid = false;
-        uiClear();
-      } else if (state == ST_CAL_RUN) {
-        stopCalibrationPump();
-        state = ST_MENU;
-        menuReset(menu);
-        _menuBackupValid = false;
-        uiClear();
-      } else if (state == ST_CAL_INPUT) {
-        state = ST_MENU;
-        menuReset(menu);
-        _menuBackupValid = false;
-        uiClear();
+  // MENU/BACK (hold)
+  if (ev.menuClick) {
+
+    // ✅ READY: довге натискання відкриває Wizard
+    if (state == ST_READY) {
+      enterWizardSafe();
+    }
+    // CANCEL in MENU editing
+    else if (state == ST_MENU && menu.editing) {
+      if (_menuBackupValid) {
+        S = _menuBackup;
       }
+      menu.editing = false;
+      _menuBackupValid = false;
+      recomputeRecAndRange();
+      uiClear();
+    }
+    // old BACK behavior
+    else if (state == ST_WIZ_REC || state == ST_RUN) {
+      enterMenu();
+    } else if (state == ST_MENU) {
+      state = ST_READY;
+      _menuBackupValid = false;
+      uiClear();
+    } else if (state == ST_CAL_RUN) {
+      stopCalibrationPump();
+      state = ST_MENU;
+      menuReset(menu);
+      _menuBackupValid = false;
+      uiClear();
+    } else if (state == ST_CAL_INPUT) {
+      state = ST_MENU;
+      menuReset(menu);
+      _menuBackupValid = false;
+      uiClear();
     }
+  }
 
-    if (ev.encStep != 0) {
-      Serial.print("encStep: "); Serial.print(ev.encStep);
-      Serial.print(" | state: "); Serial.println(state);
+  // START/STOP
+  if (ev.startClick) {
+    if (state == ST_READY) {
+      recomputeRecAndRange();
+      startRun();
+    } else if (state == ST_WIZ_MAT || state == ST_WIZ_DIA) {
+      state = ST_READY;
+      uiClear();
+    } else if (state == ST_WIZ_REC) {
+      wizardDone = true;
+      startRun();
+    } else if (state == ST_RUN) {
+      stopRunToReady();
+    } else if (state == ST_MENU) {
+      state = ST_READY;
+      _menuBackupValid = false;
+      uiClear();
+    } else if (state == ST_CAL_RUN) {
+      stopCalibrationPump();
+      state = ST_MENU;
+      menuReset(menu);
+      _menuBackupValid = false;
+      uiClear();
+    } else if (state == ST_CAL_INPUT) {
+      state = ST_MENU;
+      menuReset(menu);
+      _menuBackupValid = false;
+      uiClear();
     }
+  }
 
-_afterPollBlock:
-    ;
+  if (ev.encStep != 0) {
+    Serial.print("encStep: "); Serial.print(ev.encStep);
+    Serial.print(" | state: "); Serial.println(state);
   }
 
-  // Runtime (pump)
+}
+
+// ---- потенциометр: set_x100 в WIZ_REC / RUN
+static void taskPot() {
+  static uint8_t lastPotN = 0;
+  if (S.pot_avg_N != lastPotN) {
+    lastPotN = S.pot_avg_N;
+    potSetFilterN(S.pot_avg_N);
+    potFilterSetWindow(S.pot_avg_N);
+  }
+
+  // гистерезис меню или диапазон поменялись — мёртвая зона заново
+  static uint8_t lastHyst = 0;
+  static int32_t lastSpan = -1;
+  int32_t span = potMax_x100 - potMin_x100;
+  if (S.pot_hyst_x100 != lastHyst || span != lastSpan) {
+    lastHyst = S.pot_hyst_x100;
+    lastSpan = span;
+    potFilterSetDeadband(potDeadbandAdc());
+  }
+
+  // фильтр идёт всегда, чтобы при входе в RUN не было переходного
+  uint16_t adc = potFilterUpdate(potGetAvgAdc());
+
+  // POT only in WIZ_REC / RUN (в LCD TEST не трогаем)
+  if (lcdTestIsActive()) return;
+  if (state == ST_WIZ_REC || state == ST_RUN) {
+    // уставка пересчитывается, только когда сдвинулся выход фильтра
+    static uint16_t lastAdc = 0xFFFF;
+    static uint16_t lastEpoch = 0;
+    if (adc == lastAdc && rangeEpoch == lastEpoch) return;
+    lastAdc = adc;
+    lastEpoch = rangeEpoch;
+
+    int32_t newSet = potMap(adc, potMin_x100, potMax_x100);
+    if (newSet != set_x100) {
+      set_x100 = newSet;
+      uiInvalidate();
+    }
+  }
+}
+
+// ---- насос
+static void taskPump() {
+  PROF_SCOPE(PROF_PUMP);
   if (state == ST_RUN) {
-    if (S.mode == MODE_CONT) pumpRunCont(set_x100, S.pump_gain_steps_per_u_min);
-    else pumpRunPulse(pulseOn, pulseMs, S, set_x100);
+    // частота из таблицы по тому же выходу фильтра, что и set_x100
+    pumpLutSync(rangeEpoch, potMin_x100, potMax_x100, S.pump_gain_steps_per_u_min, POT_ADC_MAX);
+    uint16_t adc = potFilterOut();
+    if (S.mode == MODE_CONT) pumpRunContAdc(adc);
+    else pumpRunPulse(pulseOn, pulseMs, S, pumpLutRate_mHz(adc));
   } else if (state == ST_CAL_RUN) {
     pumpRunCont(CAL_FLOW_U_X100, S.pump_gain_steps_per_u_min);
 
@@ -472,10 +473,44 @@ _afterPollBlock:
       uiClear();
     }
   }
+}
+
+// ---- фоновая запись EEPROM (настройки, счётчик масла)
+static void taskPersist() {
+  settingsPoll();
+  totalizerPoll();
+}
+
+// ---- UI
+static void taskUi() {
+  PROF_SCOPE(PROF_UI);
+
+  // то, что меняется без ввода: при изменении — uiInvalidate()
+  static uint16_t calLeftShown = 0;
+  static int32_t  jobMlShown = 0;
+  static bool     savePendingShown = false;
+
+  if (state == ST_RUN) {
+    int32_t ml = totalizerJobMl_x100(S);
+    if (ml != jobMlShown) { jobMlShown = ml; uiInvalidate(); }
+  } else if (state == ST_CAL_RUN) {
+    uint16_t left = calSecondsLeft();
+    if (left != calLeftShown) { calLeftShown = left; uiInvalidate(); }
+  }
+  bool savePending = settingsSavePending();   // "..." у пункта Save
+  if (savePending != savePendingShown) { savePendingShown = savePending; uiInvalidate(); }
+
+#if PROF_ENABLE
+  // DIAG: цифры живые, обновляем пару раз в секунду
+  static uint32_t diagShownMs = 0;
+  if (state == ST_DIAG && millis() - diagShownMs >= 500) { diagShownMs = millis(); uiInvalidate(); }
+#endif
 
   // UI refresh
-  if (millis() - tUi >= UI_REFRESH_MS) {
-    tUi = millis();
+  // Только если что-то изменилось (uiInvalidate) и не чаще UI_MIN_FRAME_MS.
+  // LCD уходит в фоне: пока прошлый кадр в очереди, новый не строим;
+  // обрезанный бюджетом кадр дорисовываем сразу
+  if (uiRedrawDue()) {
 
     // ✅ Якщо тест активний — показуємо тільки його
     if (lcdTestIsActive()) {
@@ -488,7 +523,7 @@ _afterPollBlock:
       case ST_WIZ_MAT:  uiDrawWizMaterial(S); break;
       case ST_WIZ_DIA:  uiDrawWizDiameter(S); break;
       case ST_WIZ_REC:  uiDrawWizRecommend(S, rec_x100, set_x100, potMin_x100, potMax_x100); break;
-      case ST_RUN:      uiDrawRun(S, rec_x100, set_x100, true); break;
+      case ST_RUN:      uiDrawRun(S, rec_x100, set_x100, true, totalizerJobMl_x100(S)); break;
 
       case ST_MENU: {
         char l1[21], l2[21], l3[21];
@@ -496,17 +531,103 @@ _afterPollBlock:
         uiDrawMenu(menu.editing, l1, l2, l3);
       } break;
 
-      case ST_CAL_RUN: {
-        uint32_t elapsed = millis() - calStartMs;
-        uint16_t left = (elapsed >= calDurationMs) ? 0 : (uint16_t)((calDurationMs - elapsed) / 1000UL);
-        uiDrawCalRun(calTotalSec, left);
-      } break;
+      case ST_CAL_RUN:
+        uiDrawCalRun(calTotalSec, calSecondsLeft());
+        break;
 
       case ST_CAL_INPUT:
         uiDrawCalInputDigits(calMeasuredMl_x100, calDigitIdx);
         break;
 
+#if PROF_ENABLE
+      case ST_DIAG:
+        uiDrawDiag(diagPage);
+        break;
+#endif
+
       default: break;
     }
   }
 }
+
+#if PROF_ENABLE
+// ---- профайлер в Serial: 'p' — таблица участков и задач, 'r' — сброс
+static void taskDiag() {
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == 'p') {
+      profDump(Serial);
+      // Timer1 на крейсере не перезаряжается: растёт только на рампах и
+      // при смене уставки
+      Serial.print(F("pump: t1 reprograms ")); Serial.println(pumpGetReprogramCount());
+      Serial.print(F("lcd: frame ")); Serial.print(uiGetLastFrameBytes());
+      Serial.print(F(" bytes, total ")); Serial.print(uiGetLcdBytesTotal());
+      Serial.print(F(", cmds ")); Serial.println(uiGetLcdCmdTotal());
+      Serial.println(F("sched: name wcet(us) missed"));
+      for (uint8_t i = 0; i < schedTaskCount(); i++) {
+        const SchedStat &st = schedStat(i);
+        Serial.print((const __FlashStringHelper *)schedTask(i).name_P);
+        Serial.print(' '); Serial.print(st.wcetUs);
+        Serial.print(' '); Serial.println(st.missed);
+      }
+    } else if (c == 'r') {
+      profReset();
+      schedResetStats();
+      Serial.println(F("prof: reset"));
+    }
+  }
+}
+#endif
+
+// ===================== ТАБЛИЦА ЗАДАЧ =====================
+static const char TASK_INPUT_NAME[]   PROGMEM = "input";
+static const char TASK_PUMP_NAME[]    PROGMEM = "pump";
+static const char TASK_POT_NAME[]     PROGMEM = "pot";
+static const char TASK_PERSIST_NAME[] PROGMEM = "eeprom";
+static const char TASK_UI_NAME[]      PROGMEM = "ui";
+#if PROF_ENABLE
+static const char TASK_DIAG_NAME[]    PROGMEM = "diag";
+#endif
+
+// Реакция на ввод гарантирована: input идёт первым и не позже
+// INPUT_POLL_MS + худшее время задач, запущенных до него в том же проходе
+static const SchedTask tasks[] = {
+  // name               fn           период            срок    prio
+  { TASK_INPUT_NAME,    taskInput,   INPUT_POLL_MS,    10,     0 },
+  { TASK_PUMP_NAME,     taskPump,    PUMP_TASK_MS,     5,      1 },
+  { TASK_POT_NAME,      taskPot,     INPUT_POLL_MS,    20,     2 },
+  { TASK_PERSIST_NAME,  taskPersist, PERSIST_TASK_MS,  50,     3 },
+  { TASK_UI_NAME,       taskUi,      UI_TASK_MS,       50,     4 },
+#if PROF_ENABLE
+  { TASK_DIAG_NAME,     taskDiag,    100,              500,    5 },
+#endif
+};
+
+void setup() {
+  Serial.begin(9600);  // для отладки
+
+  // Общий счёт — раньше настроек: settingsLoad() может сразу запустить
+  // фоновую запись, а totalizerBegin() читает старый формат прямо из EEPROM
+  totalizerBegin();
+  settingsLoad();
+  uiBegin();
+  inputBegin();
+  potSetFilterN(S.pot_avg_N);
+  potFilterSetWindow(S.pot_avg_N);
+
+  pumpBegin();
+
+  pinMode(PIN_START_LED, OUTPUT);
+  digitalWrite(PIN_START_LED, LOW);
+
+  potFilterReset(potGetAvgAdc());
+  recomputeRecAndRange();
+  uiDrawReady(S);
+
+  schedBegin(tasks, sizeof(tasks) / sizeof(tasks[0]));
+}
+
+void loop() {
+  PROF_SCOPE(PROF_LOOP);
+  schedRun();
+}
@@ -0,0 +1,84 @@
+#include <avr/interrupt.h>
+#include "config.h"
+#include "pot.h"
+#include "prof.h"
+
+static_assert((POT_RING & (POT_RING - 1)) == 0, "POT_RING must be a power of 2");
+static_assert(POT_RING >= 16, "POT_RING must hold pot_avg_N = 16 samples");
+static constexpr uint8_t RMASK = POT_RING - 1;
+
+// Кольцо сырых 10-битных отсчётов и сумма последних potN из них:
+// ISR добавляет новый и вычитает выпавший из окна, чтение — O(1)
+static uint16_t ring[POT_RING];
+static uint8_t head = 0;
+static volatile uint16_t sum = 0;     // до 16 * 1023, в 16 бит влезает
+static volatile uint8_t potN = 8;
+static uint8_t potShift = 3;          // potN = 1 << potShift
+
+ISR(ADC_vect) {
+  PROF_SCOPE(PROF_ISR_ADC);
+
+  uint16_t v = ADC;
+  uint8_t h = head;
+  sum += v - ring[(uint8_t)(h - potN) & RMASK];
+  ring[h] = v;
+  head = (uint8_t)(h + 1) & RMASK;
+}
+
+// Сумма окна заново из кольца (при cli())
+static void resum() {
+  uint16_t s = 0;
+  for (uint8_t i = 1; i <= potN; i++) s += ring[(uint8_t)(head - i) & RMASK];
+  sum = s;
+}
+
+void potBegin() {
+  uint8_t ch = (uint8_t)(PIN_POT - A0);
+  pinMode(PIN_POT, INPUT);
+  DIDR0 |= (uint8_t)(1 << ch);        // цифровой вход на аналоговом пине не нужен
+
+  ADMUX = (1 << REFS0) | (ch & 0x07); // AVcc, как analogRead() по умолчанию
+
+  // Первый отсчёт ждём здесь, чтобы кольцо сразу было заполнено
+  ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  while (ADCSRA & (1 << ADSC)) {}
+  uint16_t v = ADC;
+
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t i = 0; i < POT_RING; i++) ring[i] = v;
+  head = 0;
+  resum();
+
+  // Дальше сам: запуск по TOV0 (millis уже крутит Timer0), 125 кГц АЦП
+  ADCSRB = (1 << ADTS2);
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADIF)
+         | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  SREG = sreg;
+}
+
+void potSetFilterN(uint8_t N) {
+  // степень двойки 4..16: среднее — сдвигом, без деления
+  uint8_t sh = 2;
+  while (sh < 4 && (uint8_t)(1 << (sh + 1)) <= N) sh++;
+
+  uint8_t sreg = SREG;
+  cli();
+  if (sh != potShift) {
+    potShift = sh;
+    potN = (uint8_t)(1 << sh);
+    resum();
+  }
+  SREG = sreg;
+}
+
+uint16_t potGetAvgAdc() {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t s = sum;
+  uint8_t sh = potShift;
+  SREG = sreg;
+
+  // к 12 битам: sum * 4 / N (sum * 4 <= 16 * 4092, в 16 бит влезает)
+  return (uint16_t)(s << 2) >> sh;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+
+// Потенциометр: АЦП сам меряет PIN_POT в прерывании (запуск по
+// переполнению Timer0, ~1 кГц) и кладёт отсчёты в кольцо. Чтение не ждёт
+// преобразования (analogRead ~110 мкс) — только берёт готовую сумму.
+// Среднее по N отсчётам (оверсэмплинг) даёт 12 бит вместо 10.
+
+constexpr uint16_t POT_ADC_MAX = 1023 * 4;   // шкала potGetAvgAdc()
+
+void potBegin();
+
+// N = S.pot_avg_N: 4, 8 или 16 отсчётов в среднем (окно 4..16 мс)
+void potSetFilterN(uint8_t N);
+
+// 0..POT_ADC_MAX, одно значение для всех; сглаживание для уставки — pot_filter.h
+uint16_t potGetAvgAdc();
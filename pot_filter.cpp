@@ -0,0 +1,47 @@
+#include "config.h"
+#include "pot.h"
+#include "pot_filter.h"
+
+// Отфильтрованное значение с 4 дробными битами: 4092 * 16 в 16 бит влезает
+static uint16_t y16 = 0;
+static uint16_t out = 0;
+static uint16_t deadband = 0;
+static uint8_t slowShift = 3;        // окно 1 << slowShift опросов
+
+void potFilterSetWindow(uint8_t N) {
+  uint8_t sh = 0;
+  while (sh < 4 && (uint8_t)(1 << (sh + 1)) <= N) sh++;
+  slowShift = sh;
+}
+
+void potFilterSetDeadband(uint16_t adc) {
+  deadband = adc;
+}
+
+void potFilterReset(uint16_t adc) {
+  y16 = (uint16_t)(adc << 4);
+  out = adc;
+}
+
+uint16_t potFilterUpdate(uint16_t adc) {
+  int32_t e16 = ((int32_t)adc << 4) - y16;
+  uint16_t a = (uint16_t)((e16 < 0 ? -e16 : e16) >> 4);
+
+  // каждое удвоение разницы сверх шума — окно вдвое короче
+  uint8_t sh = slowShift;
+  for (uint16_t t = POT_FILT_NOISE; a > t && sh > 0; t <<= 1) sh--;
+  int32_t step = e16 >> sh;
+  if (step == 0 && e16 > 0) step = 1;   // доползти до входа (вниз сдвиг и так даёт -1)
+  y16 = (uint16_t)(y16 + step);
+
+  // мёртвая зона — по округлённому значению, выход прыгает сразу на него;
+  // края шкалы доступны всегда
+  uint16_t y = (uint16_t)((y16 + 8) >> 4);
+  uint16_t d = (y > out) ? (uint16_t)(y - out) : (uint16_t)(out - y);
+  if (d != 0 && (d >= deadband || y == 0 || y == POT_ADC_MAX)) out = y;
+  return out;
+}
+
+uint16_t potFilterOut() {
+  return out;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <Arduino.h>
+
+// Фильтр потенциометра поверх potGetAvgAdc(), вызывается раз в опрос.
+// Постоянная времени адаптивная: пока ручку не трогают (разница с
+// выходом на уровне шума) — сглаживание по окну pot_avg_N опросов; чем
+// больше разница, тем короче окно, резкий поворот проходит сразу.
+// Выход держится, пока отфильтрованное значение не уйдёт дальше
+// мёртвой зоны (pot_hyst_x100, пересчитанная в отсчёты АЦП).
+
+void potFilterSetWindow(uint8_t N);          // S.pot_avg_N: 4, 8, 16 опросов
+void potFilterSetDeadband(uint16_t adc);     // в единицах potGetAvgAdc()
+void potFilterReset(uint16_t adc);           // сразу на значение, без переходного
+
+uint16_t potFilterUpdate(uint16_t adc);      // новый отсчёт -> выход
+uint16_t potFilterOut();                     // последний выход
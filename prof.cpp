@@ -0,0 +1,81 @@
+#include "prof.h"
+
+#if PROF_ENABLE
+
+#include <string.h>
+
+static ProfStat stats[PROF_COUNT];
+
+static const char N_LOOP[]  PROGMEM = "loop";
+static const char N_INPUT[] PROGMEM = "input";
+static const char N_PUMP[]  PROGMEM = "pump";
+static const char N_UI[]    PROGMEM = "ui";
+static const char N_LCD[]   PROGMEM = "lcd diff";
+static const char N_ENC[]   PROGMEM = "isr enc";
+static const char N_T1[]    PROGMEM = "isr T1";
+static const char N_T2[]    PROGMEM = "isr T2";
+static const char N_TWI[]   PROGMEM = "isr TWI";
+static const char N_ADC[]   PROGMEM = "isr ADC";
+
+static const char *const names[PROF_COUNT] PROGMEM = {
+  N_LOOP, N_INPUT, N_PUMP, N_UI, N_LCD, N_ENC, N_T1, N_T2, N_TWI, N_ADC
+};
+
+// Участок пишет только один контекст (ISR не вложены), поэтому без cli()
+void profRecord(uint8_t id, uint16_t ticks) {
+  ProfStat &s = stats[id];
+  if (s.n == 0 || ticks < s.minT) s.minT = ticks;
+  if (ticks > s.maxT) s.maxT = ticks;
+  s.sumT += ticks;
+  s.n++;
+
+  // корзина: 0 — меньше 4 тиков (16 мкс), дальше каждая вдвое шире
+  uint8_t b = 0;
+  for (uint16_t v = ticks >> 2; v && b < PROF_BUCKETS - 1; v >>= 1) b++;
+  if (s.hist[b] != 0xFFFF) s.hist[b]++;
+}
+
+void profReset() {
+  uint8_t sreg = SREG;
+  cli();
+  memset(stats, 0, sizeof(stats));
+  SREG = sreg;
+}
+
+void profGet(uint8_t id, ProfStat &out) {
+  uint8_t sreg = SREG;
+  cli();
+  out = stats[id];
+  SREG = sreg;
+}
+
+const char *profName_P(uint8_t id) {
+  return (const char *)pgm_read_ptr(&names[id]);
+}
+
+void profDump(Print &out) {
+  out.println(F("prof: name n min avg max (us) | hist <16us x2 ..."));
+  for (uint8_t i = 0; i < PROF_COUNT; i++) {
+    ProfStat s;
+    profGet(i, s);
+    out.print((const __FlashStringHelper *)profName_P(i));
+    out.print(' ');
+    out.print(s.n);
+    if (s.n) {
+      out.print(' ');
+      out.print((unsigned long)s.minT * 4);
+      out.print(' ');
+      out.print((unsigned long)(s.sumT / s.n) * 4);
+      out.print(' ');
+      out.print((unsigned long)s.maxT * 4);
+    }
+    out.print(F(" |"));
+    for (uint8_t b = 0; b < PROF_BUCKETS; b++) {
+      out.print(' ');
+      out.print((unsigned)s.hist[b]);
+    }
+    out.println();
+  }
+}
+
+#endif
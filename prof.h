@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Профайлер: время участков loop() и ISR по Timer0 (тот же счётчик, что у
+// millis/micros: тик 4 мкс = 64 такта). Timer1 и Timer2 заняты насосом,
+// свободного таймера с тактовым разрешением нет.
+// Для каждого участка: min/avg/max и гистограмма по степеням двойки.
+// PROF_ENABLE 0 (config.h) — макросы пустые, код и RAM не тратятся.
+
+enum ProfId : uint8_t {
+  PROF_LOOP = 0,   // один проход loop() (schedRun)
+  PROF_INPUT,      // задача ввода
+  PROF_PUMP,       // задача насоса
+  PROF_UI,         // задача UI (построение кадра)
+  PROF_LCD_DIFF,   // diff кадра и постановка в очередь LCD
+  PROF_ISR_ENC,    // INT0/INT1 энкодера
+  PROF_ISR_T1,     // TIMER1_COMPA (STEP)
+  PROF_ISR_T2,     // TIMER2_COMPA (рампа, PULSE, счёт шагов)
+  PROF_ISR_TWI,    // TWI: байт в PCF8574 (I2C LCD)
+  PROF_ISR_ADC,    // ADC: отсчёт потенциометра
+  PROF_COUNT
+};
+
+constexpr uint8_t PROF_BUCKETS = 8;   // <16 мкс, <32, <64 ... <1024, >=1024
+
+struct ProfStat {
+  uint16_t minT, maxT;         // тики по 4 мкс
+  uint32_t sumT;
+  uint32_t n;
+  uint16_t hist[PROF_BUCKETS];
+};
+
+#if PROF_ENABLE
+
+extern "C" volatile unsigned long timer0_overflow_count;   // wiring.c
+
+// Тики Timer0 (4 мкс), 16 бит — хватает на участки до 262 мс
+static inline uint16_t profNow() {
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t t = TCNT0;
+  uint16_t ovf = (uint16_t)timer0_overflow_count;
+  if ((TIFR0 & (1 << TOV0)) && t < 255) ovf++;   // переполнение ещё не обработано
+  SREG = sreg;
+  return (uint16_t)(ovf << 8) | t;
+}
+
+void profRecord(uint8_t id, uint16_t ticks);
+
+struct ProfScope {
+  uint8_t id;
+  uint16_t t0;
+  explicit ProfScope(uint8_t i) : id(i), t0(profNow()) {}
+  ~ProfScope() { profRecord(id, (uint16_t)(profNow() - t0)); }
+};
+
+// Замер до конца текущего блока (в т.ч. ISR с ранним return)
+#define PROF_SCOPE(id) ProfScope _profScope(id)
+
+void profReset();
+void profGet(uint8_t id, ProfStat &out);   // снимок (атомарно к ISR)
+const char *profName_P(uint8_t id);
+void profDump(Print &out);                 // таблица в Serial
+
+#else
+
+#define PROF_SCOPE(id) ((void)0)
+
+#endif
@@ -1,13 +1,32 @@
 #include <Arduino.h>
 #include "config.h"
 #include "pump.h"
+#include "prof.h"
 
 static volatile bool stepEnable = false;
 
+// ===== Счётчик шагов =====
+// Считаются реально выданные шаги. Программный STEP и HW режим на частотах до
+// PUMP_DDS_MAX_CMP_HZ фронтов — в ISR совпадения Timer1 (точно, по фронтам).
+// Выше ISR на каждый фронт не успевает: тогда тик Timer2 (1 мс) прибавляет
+// шаги/мс действующего периода в Q16, а смена периода посреди миллисекунды
+// делит её по TCNT2 (fastRateSet) — ошибка в доли шага на смену периода.
+static volatile uint32_t stepCount = 0;
+static volatile uint8_t  stepHalf = 0;     // HW: чётность фронтов (шаг = 2 фронта)
+static volatile uint32_t fastStepQ16 = 0;  // шагов за 1 мс, Q16 (0 = считает ISR)
+static volatile int32_t  fastAccQ16 = 0;   // остаток шага, Q16 (< 0 — аванс за начало мс)
+
+#if PUMP_STEP_HW
+// OC1A переключается на каждом совпадении: 1 шаг = 2 совпадения (фронт + спад)
+static constexpr uint8_t EDGES_PER_STEP = 2;
+#else
+static constexpr uint8_t EDGES_PER_STEP = 1;
+#endif
+
 // --- Timer1: CTC, частота задаётся через OCR1A + прескалер
 static void timer1Init() {
   cli();
-  TCCR1A = 0;
+  TCCR1A = 0;   // OC1A отключён от пина (COM1A = 00)
   TCCR1B = 0;
 
   // CTC mode
@@ -22,52 +41,517 @@ static void timer1Init() {
   sei();
 }
 
-static void setPrescalerBits(uint16_t presc) {
-  // Clear CS12..CS10
-  TCCR1B &= ~((1 << CS12) | (1 << CS11) | (1 << CS10));
+// Прескалеры 1, 8, 64, 256, 1024 = сдвиги 0, 3, 6, 8, 10
+static inline void setPrescalerShift(uint8_t shift) {
+  uint8_t cs;
+  switch (shift) {
+    case 0:  cs = (1 << CS10); break;
+    case 3:  cs = (1 << CS11); break;
+    case 6:  cs = (1 << CS11) | (1 << CS10); break;
+    case 8:  cs = (1 << CS12); break;
+    default: cs = (1 << CS12) | (1 << CS10); break; // 1024
+  }
+  TCCR1B = (TCCR1B & ~((1 << CS12) | (1 << CS11) | (1 << CS10))) | cs;
+}
+
+#if PUMP_STEP_HW
+// Подключение OC1A к пину STEP.
+//  on:  toggle на совпадении (COM1A = 01)
+//  off: clear на совпадении (COM1A = 10) — если пин сейчас HIGH, он уйдёт в LOW
+//       на ближайшем совпадении, импульс не обрезается "огрызком"
+static void stepOutputSet(bool on) {
+  uint8_t tccr = TCCR1A & ~((1 << COM1A1) | (1 << COM1A0));
+  tccr |= on ? (1 << COM1A0) : (1 << COM1A1);
+  TCCR1A = tccr;
+}
+#endif
+
+// ===== DDS: период между совпадениями с дробной частью =====
+// Период хранится в тактах CPU, fixed-point Q6 (1/64 такта). Целая часть идёт
+// в OCR1A, дробная — в фазовый аккумулятор: каждый раз, когда он
+// переполняется, период удлиняется на 1 тик. Средняя частота шагов в итоге
+// совпадает с заданной в mHz с точностью до 1/64 тика таймера на период.
+static constexpr uint8_t PERIOD_Q = 6;
+
+// Самый длинный период Timer1: 65536 тиков * 1024 = 2^26 тактов
+static constexpr uint32_t PUMP_MIN_STEP_MHZ =
+  (uint32_t)((F_CPU * 1000ULL + (1ULL << 26) * EDGES_PER_STEP - 1) / ((1ULL << 26) * EDGES_PER_STEP));
+
+struct TimerPeriod {
+  uint16_t ocr;    // целая часть периода - 1
+  uint8_t  shift;  // прескалер (сдвиг)
+  uint8_t  frac;   // дробная часть периода: Q6 в старших битах байта, шаг 1/64 тика
+                   // (0 = без ISR в HW режиме)
+};
+
+// Крейсерский период (после разгона)
+static volatile uint16_t ddsOcr = 0;
+static volatile uint8_t  ddsShift = 10;
+static volatile uint8_t  ddsFrac = 0;
+static volatile uint8_t  ddsPhase = 0;  // фазовый аккумулятор
+
+// Следующий период (вызывается из ISR сразу после совпадения: TCNT1 уже
+// сброшен, поэтому новый OCR1A действует на текущий период без глитча)
+static inline void ddsNextPeriod() {
+  uint8_t ph = ddsPhase + ddsFrac;
+  OCR1A = ddsOcr + (ph < ddsPhase ? 1 : 0);
+  ddsPhase = ph;
+}
+
+static uint32_t clampRate_mHz(uint32_t mHz) {
+  if (mHz < PUMP_MIN_STEP_MHZ) mHz = PUMP_MIN_STEP_MHZ;
+  if (mHz > PUMP_MAX_STEP_HZ * 1000UL) mHz = PUMP_MAX_STEP_HZ * 1000UL;
+  return mHz;
+}
+
+// Такты CPU между совпадениями OCR1A, Q6
+// (в HW режиме совпадений вдвое больше, чем шагов)
+static uint32_t periodQFor_mHz(uint32_t mHz) {
+  mHz = clampRate_mHz(mHz);
+  uint64_t den = (uint64_t)mHz * EDGES_PER_STEP;
+  return (uint32_t)(((uint64_t)F_CPU * 1000ULL * (1UL << PERIOD_Q) + den / 2) / den);
+}
 
-  switch (presc) {
-    case 1:    TCCR1B |= (1 << CS10); break;
-    case 8:    TCCR1B |= (1 << CS11); break;
-    case 64:   TCCR1B |= (1 << CS11) | (1 << CS10); break;
-    case 256:  TCCR1B |= (1 << CS12); break;
-    case 1024: TCCR1B |= (1 << CS12) | (1 << CS10); break;
-    default:   TCCR1B |= (1 << CS11); break; // 8
+// Самый “быстрый” прескалер, у которого целая часть + перенос ещё влезают
+// в OCR1A (0..65535)
+static uint8_t prescShiftFor(uint32_t periodQ) {
+  static const uint8_t prescShift[] = {0, 3, 6, 8, 10};
+  for (uint8_t i = 0; i < sizeof(prescShift); i++) {
+    if ((periodQ >> (prescShift[i] + PERIOD_Q)) <= 65535UL) return prescShift[i];
   }
+  return 10;
 }
 
-// Подбор прескалера чтобы OCR1A влезал в 16 бит (0..65535)
-static void pumpSetRateHz(uint16_t hz) {
-  if (hz < 1) hz = 1;
-  if (hz > 2000) hz = 2000; // безопасный максимум для ISR
+// Период в тактах Q6 -> OCR1A/прескалер/дробь (только сдвиги)
+static TimerPeriod periodFromQ(uint32_t period, bool allowFrac) {
+  uint8_t shift = prescShiftFor(period);
 
-  const uint16_t prescList[] = {1, 8, 64, 256, 1024};
-  uint16_t bestPresc = 1024;
-  uint32_t bestOcr = 65535;
+  uint32_t ticksQ = period >> shift;   // тики таймера, Q6
+  uint32_t ticks = ticksQ >> PERIOD_Q;
+  if (ticks < 2) { ticks = 2; ticksQ = ticks << PERIOD_Q; }
+  if (ticks > 65535UL) { ticks = 65535UL; ticksQ = ticks << PERIOD_Q; }
+  uint8_t frac = (uint8_t)((ticksQ & ((1U << PERIOD_Q) - 1)) << (8 - PERIOD_Q));
 
-  for (uint8_t i = 0; i < sizeof(prescList) / sizeof(prescList[0]); i++) {
-    uint16_t p = prescList[i];
-    uint32_t ocr = (F_CPU / (uint32_t)p / (uint32_t)hz) - 1UL;
-    if (ocr <= 65535UL) {
-      bestPresc = p;
-      bestOcr = ocr;
-      break; // берём самый “быстрый” прескалер, который влезает
-    }
+#if PUMP_STEP_HW
+  // Без ISR дробь не накопить. Выше PUMP_DDS_MAX_CMP_HZ прерывание на каждом
+  // фронте дороже, чем ошибка округления периода до целого тика
+  // (не больше 0.5 тика: 0.06% на 20 кГц фронтов, 0.6% на 200 кГц).
+  if (period < ((F_CPU / PUMP_DDS_MAX_CMP_HZ) << PERIOD_Q)) allowFrac = false;
+#endif
+  if (!allowFrac) {
+    if (frac >= 128 && ticks < 65535UL) ticks++;
+    frac = 0;
+  }
+
+  TimerPeriod p;
+  p.ocr = (uint16_t)(ticks - 1);
+  p.shift = shift;
+  p.frac = frac;
+  return p;
+}
+
+static TimerPeriod periodFor_mHz(uint32_t mHz, bool allowFrac) {
+  return periodFromQ(periodQFor_mHz(mHz), allowFrac);
+}
+
+// ===== Смена периода на ходу =====
+// В CTC OCR1A не буферизуется: запись посреди периода даёт длинный (счётчик
+// уже прошёл новое значение и идёт до 0xFFFF) или сдвоенный шаг, смена
+// прескалера посреди счёта — тоже. Поэтому новый период только "заряжается",
+// а в OCR1A/TCCR1B его пишет ISR совпадения — сразу после сброса TCNT1, т.е.
+// на границе периода. ISR при этом включается на один раз (в HW режиме).
+static volatile bool     t1Pending = false;
+static volatile uint16_t t1PendOcr = 0;
+static volatile uint8_t  t1PendShift = 0;
+static volatile uint32_t t1PendFastQ16 = 0;
+static uint16_t t1Ocr = 0;        // заряженный/действующий период (без DDS-дроби)
+static uint8_t  t1Shift = 0xFF;
+static bool     t1Fresh = false;  // счёт только что запущен с нуля: писать сразу
+static volatile bool t1Slow = true; // действующий период: ISR на каждый фронт успевает
+static volatile uint32_t t1Reprograms = 0;
+
+// Период короче этого (в тактах CPU) — шаги считает тик Timer2, не ISR
+static constexpr uint32_t T1_ISR_MIN_CYCLES = F_CPU / PUMP_DDS_MAX_CMP_HZ;
+
+// Шагов за 1 мс для периода (0 = медленный, считаем в ISR)
+static uint32_t fastStepsQ16For(uint16_t ocr, uint8_t shift) {
+#if PUMP_STEP_HW
+  uint32_t cycles = (uint32_t)(ocr + 1UL) << shift;
+  if (cycles >= T1_ISR_MIN_CYCLES) return 0;
+  return ((F_CPU / 1000UL) << 16) / (cycles * EDGES_PER_STEP);
+#else
+  (void)ocr; (void)shift;
+  return 0;
+#endif
+}
+
+// Включить тик Timer2. Флаг совпадения, взведённый, пока тик был выключен,
+// устарел: с ним ISR сработал бы сразу, посреди миллисекунды
+static inline void timer2TickOn() {
+  if (TIMSK2 & (1 << OCIE2A)) return;
+  TIFR2 = (1 << OCF2A);
+  TIMSK2 |= (1 << OCIE2A);
+}
+
+// Новые шаги/мс посреди миллисекунды Timer2 (при cli() или из ISR). Тик
+// прибавит q16 за всю мс, поэтому прошедшая её доля зачитывается по старому
+// периоду, а по новому — вычитается. Доля — TCNT2 из 250, растянутый до
+// 1/256 (x1.023) без деления. Разница (< 2^23 при 100 кГц) умножается до
+// сдвига: рампа меняет период каждые 1-2 мс, и отброшенные сдвигом младшие
+// биты за торможение набегали в целый шаг
+static void fastRateSet(uint32_t q16) {
+  uint32_t old = fastStepQ16;
+  if (q16 == old) return;
+  uint16_t done = TCNT2;
+  done += (done * 3) >> 7;
+  int32_t acc = fastAccQ16 + ((((int32_t)old - (int32_t)q16) * (int32_t)done) >> 8);
+  if (acc > 0) {
+    stepCount += (uint32_t)acc >> 16;
+    acc &= 0xFFFF;
+  }
+  fastAccQ16 = acc;
+  fastStepQ16 = q16;
+}
+
+static inline void timer1Load(uint16_t ocr, uint8_t shift, uint32_t fastQ16) {
+  setPrescalerShift(shift);
+  OCR1A = ocr;
+  // ISR мог опоздать на несколько тиков прескалера 1
+  if (TCNT1 >= ocr) TCNT1 = ocr - 1;
+
+  fastRateSet(fastQ16);
+  t1Slow = (fastQ16 == 0);
+  if (fastQ16) timer2TickOn();   // считать будет тик Timer2
+}
+
+// Вызывать при cli()
+static void timer1Apply(uint16_t ocr, uint8_t shift) {
+  if (!t1Fresh && ocr == t1Ocr && shift == t1Shift) return;  // уже стоит/заряжен
+  t1Ocr = ocr;
+  t1Shift = shift;
+  t1Reprograms++;
+  uint32_t fastQ16 = fastStepsQ16For(ocr, shift);
+
+  if (t1Fresh) {
+    t1Fresh = false;
+    t1Pending = false;
+    timer1Load(ocr, shift, fastQ16);
+    return;
+  }
+
+  t1PendOcr = ocr;
+  t1PendShift = shift;
+  t1PendFastQ16 = fastQ16;
+  t1Pending = true;
+  TIMSK1 |= (1 << OCIE1A);
+}
+
+// ===== Разгон / торможение =====
+// Частота идёт по прямой from +- a*t: тик Timer2 (1 мс) двигает её на a mHz
+// (a шаг/с^2 = a mHz за мс) и раз в rampLvlMs мс ставит в Timer1 ступень —
+// середину следующего отрезка прямой, так что и средняя частота, и
+// длительность рампы совпадают с планом. Ступень — не больше
+// PUMP_RAMP_LEVEL_HZ, а при коротком шаге (1 мс) — не больше
+// PUMP_RAMP_START_HZ, с которой мотор и так стартует без рампы.
+// Период ступени — одно 32-битное деление в ISR раз в ступень: в HW режиме
+// у Timer1 нет ISR на каждый фронт, да и на 100 кГц он бы не успел.
+// Рампа идёт только выше PUMP_RAMP_START_HZ (ниже мотор переключается
+// сразу), поэтому прескалер у ступеней один.
+static volatile bool     rampActive = false; // false = разгона нет, идёт крейсер
+static volatile bool     rampStop = false;   // после торможения остановить мотор
+static volatile bool     running = false;    // STEP генерируется (в т.ч. торможение)
+
+static uint32_t rampCur_mHz = 0;   // прямая на текущую мс
+static uint32_t rampTo_mHz = 0;
+static uint32_t rampA_mHz = 0;     // изменение за 1 мс
+static uint32_t rampLvl_mHz = 0;   // частота ступени в Timer1
+static uint16_t rampHalf_mHz = 0;  // пол-ступени
+static uint8_t  rampLvlMs = 1;
+static uint8_t  rampLeftMs = 0;
+static bool     rampUp = true;
+
+static uint32_t target_mHz = 0;   // крейсерская частота
+static uint32_t accel_sps2 = 0;   // 0 = без разгона
+static uint32_t decel_sps2 = 0;   // 0 = без торможения
+
+static constexpr uint32_t RAMP_START_MHZ = PUMP_RAMP_START_HZ * 1000UL;
+
+// ===== PULSE: импульсная подача =====
+// ON/OFF фазы отсчитывает тот же тик Timer2 (ровно 1 мс), поэтому моменты
+// включения/выключения не зависят от того, чем занят loop() (LCD, EEPROM).
+// В начале ON-фазы запускается заранее спланированный разгон.
+static volatile bool     pulseActive = false;
+static volatile bool     pulsePhaseOn = false;
+static volatile uint16_t pulseLeftMs = 0;
+static uint16_t pulseOnMs = 0;
+static uint16_t pulseOffMs = 0;
+
+// --- Timer2: CTC 1 кГц, тик рампы и PULSE
+static void timer2Init() {
+  cli();
+  TCCR2A = (1 << WGM21);                 // CTC
+  TCCR2B = (1 << CS22);                  // /64
+  OCR2A = (uint8_t)(F_CPU / 64UL / 1000UL - 1UL);
+  TIMSK2 &= ~(1 << OCIE2A);
+  sei();
+}
+
+// true если ISR нужен на крейсере (программный STEP или DDS-дробь в HW режиме)
+static inline bool cruiseNeedsIsr() {
+#if PUMP_STEP_HW
+  return ddsFrac != 0;
+#else
+  return true;
+#endif
+}
+
+// Тик Timer2 нужен пока идёт рампа или PULSE
+static inline void timer2Sync() {
+  if (rampActive || pulseActive || fastStepQ16) timer2TickOn();
+  else                                       TIMSK2 &= ~(1 << OCIE2A);
+}
+
+static void stepTrainOff() {
+  stepEnable = false;
+  running = false;
+  rampActive = false;
+  rampStop = false;
+#if PUMP_STEP_HW
+  stepOutputSet(false);
+#endif
+  t1Pending = false;
+  fastRateSet(0);
+  TIMSK1 &= ~(1 << OCIE1A);
+  timer2Sync();
+}
+
+static void cruiseApply() {
+  timer1Apply(ddsOcr, ddsShift);
+  ddsPhase = 0;
+  if (t1Pending || t1Slow || cruiseNeedsIsr()) TIMSK1 |= (1 << OCIE1A);
+  else                                         TIMSK1 &= ~(1 << OCIE1A);
+}
+
+static constexpr uint8_t rampShiftFor(uint32_t cycles) {
+  return (cycles <= 65536UL) ? 0 : (cycles <= 65536UL * 8) ? 3 : (cycles <= 65536UL * 64) ? 6
+       : (cycles <= 65536UL * 256) ? 8 : 10;
+}
+static constexpr uint8_t RAMP_SHIFT = rampShiftFor(F_CPU / (PUMP_RAMP_START_HZ * EDGES_PER_STEP));
+// тики = (F_CPU >> RAMP_SHIFT) * 1000 / (mHz * EDGES); числитель и знаменатель
+// поделены на 4, чтобы уместиться в 32 бита
+static constexpr uint32_t RAMP_NUM = (F_CPU >> RAMP_SHIFT) * 250UL;
+static_assert((F_CPU >> RAMP_SHIFT) * 250ULL <= 0xFFFFFFFFULL, "RAMP_NUM must fit 32 bits");
+static_assert(PUMP_RAMP_LEVEL_HZ >= 1 && PUMP_RAMP_LEVEL_HZ <= PUMP_RAMP_START_HZ,
+              "PUMP_RAMP_LEVEL_HZ must be 1..PUMP_RAMP_START_HZ");
+
+// Ступень: частота на середине следующих rampLvlMs мс прямой (из ISR / при cli())
+static void rampLevel() {
+  uint32_t v = rampUp ? rampCur_mHz + rampHalf_mHz : rampCur_mHz - rampHalf_mHz;
+  if (rampUp ? (v > rampTo_mHz) : (v < rampTo_mHz)) v = rampTo_mHz;
+  rampLvl_mHz = v;
+
+  uint32_t den = (v * EDGES_PER_STEP) >> 2;
+  uint32_t ticks = (RAMP_NUM + den / 2) / den;
+  if (ticks < 2) ticks = 2;
+  if (ticks > 65536UL) ticks = 65536UL;
+  timer1Apply((uint16_t)(ticks - 1), RAMP_SHIFT);
+}
+
+static inline void rampTick() {
+  bool done;
+  if (rampUp) {
+    rampCur_mHz += rampA_mHz;
+    done = (rampCur_mHz >= rampTo_mHz);
+  } else {
+    rampCur_mHz -= rampA_mHz;
+    done = (rampCur_mHz <= rampTo_mHz);
+  }
+
+  if (!done) {
+    if (--rampLeftMs) return;
+    rampLeftMs = rampLvlMs;
+    rampLevel();
+    return;
+  }
+
+  // рампа закончилась
+  if (rampStop) {
+    stepTrainOff();
+    digitalWrite(PIN_ENA, HIGH);  // disable (inverted)
+    return;
   }
 
+  rampActive = false;
+  timer2Sync();
+  cruiseApply();
+}
+
+// Текущая частота; рампа "замораживается" на текущей ступени (она становится
+// крейсером), чтобы спокойно начать новую. Вызывать при cli().
+static uint32_t rampFreeze() {
+  if (!running) return 0;
+  if (!rampActive) return target_mHz;
+
+  ddsOcr = t1Ocr;
+  ddsShift = t1Shift;
+  ddsFrac = 0;
+  rampActive = false;
+  rampStop = false;
+  timer2Sync();
+  return rampLvl_mHz;
+}
+
+// Рампа от from к to с ускорением a (шаг/с^2), первая ступень — сразу.
+// Вызывать при cli(). false — рампа не нужна (a = 0 или разница не больше
+// одной мс разгона), можно переключаться сразу
+static bool rampBegin(uint32_t from_mHz, uint32_t to_mHz, uint32_t a_sps2) {
+  if (from_mHz < RAMP_START_MHZ) from_mHz = RAMP_START_MHZ;
+  if (to_mHz < RAMP_START_MHZ) to_mHz = RAMP_START_MHZ;
+  // за 1 мс — не больше стартовой частоты
+  if (a_sps2 > RAMP_START_MHZ) a_sps2 = RAMP_START_MHZ;
+
+  bool up = (to_mHz > from_mHz);
+  uint32_t span = up ? (to_mHz - from_mHz) : (from_mHz - to_mHz);
+  if (a_sps2 == 0 || span <= a_sps2) return false;
+
+  uint32_t lvl = PUMP_RAMP_LEVEL_HZ * 1000UL / a_sps2;
+  if (lvl == 0) lvl = 1;
+  if (lvl > 255) lvl = 255;
+
+  rampUp = up;
+  rampCur_mHz = from_mHz;
+  rampTo_mHz = to_mHz;
+  rampA_mHz = a_sps2;
+  rampLvlMs = (uint8_t)lvl;
+  rampHalf_mHz = (uint16_t)(a_sps2 * lvl / 2);
+  rampLeftMs = (uint8_t)lvl;
+  rampActive = true;
+  rampLevel();
+#if PUMP_STEP_HW
+  // на ступенях DDS-дробь не нужна, ISR — для заряженного периода и счёта шагов
+  if (t1Pending || t1Slow) TIMSK1 |= (1 << OCIE1A);
+  else                     TIMSK1 &= ~(1 << OCIE1A);
+#else
+  TIMSK1 |= (1 << OCIE1A);       // программный STEP
+#endif
+  timer2TickOn();
+  return true;
+}
+
+static void stepTrainStart() {
+  TCNT1 = 0;
+  // Timer1 считал и после стопа: взведённый тогда OCF1A дал бы ISR сразу,
+  // без фронта, и stepHalf сбился бы на полшага
+  TIFR1 = (1 << OCF1A);
+  t1Fresh = true;
+  ddsPhase = 0;
+  stepHalf = 0;
+  stepEnable = true;
+  running = true;
+#if PUMP_STEP_HW
+  // После стопа посреди шага OC1A ещё HIGH (clear ждёт совпадения): первый
+  // toggle дал бы спад, и чётность stepHalf перевернулась бы. FOC1A при
+  // COM1A = 10 сбрасывает OC1A сразу, без совпадения и без ISR
+  stepOutputSet(false);
+  TCCR1C = (1 << FOC1A);
+  stepOutputSet(true);
+#endif
+}
+
+// Переключение фазы PULSE (из ISR Timer2)
+static void pulseGate(bool on) {
+  pulsePhaseOn = on;
+  pulseLeftMs = on ? pulseOnMs : pulseOffMs;
+
+  if (!on) {
+    // без торможения: пауза короткая, мотор просто встаёт
+    stepTrainOff();
+    return;
+  }
+
+  stepTrainStart();
+  if (!rampBegin(RAMP_START_MHZ, target_mHz, accel_sps2)) cruiseApply();
+}
+
+// Крейсер mHz (уже в пределах clampRate_mHz) с готовым периодом
+static void pumpSetTarget(uint32_t mHz, const TimerPeriod &cruise) {
   uint8_t sreg = SREG;
   cli();
-  setPrescalerBits(bestPresc);
-  OCR1A = (uint16_t)bestOcr;
+  if (pulseActive) {
+    // из PULSE в CONT: текущая ON-фаза становится стартом
+    pulseActive = false;
+    timer2Sync();
+  }
+  uint32_t from = rampFreeze();
+  bool fromRest = (from == 0);
+
+  target_mHz = mHz;
+  ddsOcr = cruise.ocr;
+  ddsShift = cruise.shift;
+  ddsFrac = cruise.frac;
+
+  if (fromRest) stepTrainStart();
+
+  // с места — разгон от стартовой частоты, на ходу — к новой частоте
+  bool ramp = (mHz > from) ? rampBegin(fromRest ? RAMP_START_MHZ : from, mHz, accel_sps2)
+                           : rampBegin(from, mHz, decel_sps2);
+  if (!ramp) cruiseApply();
   SREG = sreg;
 }
 
+static void pumpSetTarget_mHz(uint32_t mHz) {
+  mHz = clampRate_mHz(mHz);
+  if (running && !rampStop && !pulseActive && mHz == target_mHz) return;  // ничего не изменилось
+
+  pumpSetTarget(mHz, periodFor_mHz(mHz, true));
+}
+
 ISR(TIMER1_COMPA_vect) {
+  PROF_SCOPE(PROF_ISR_T1);
+
+  if (t1Pending) {
+    t1Pending = false;
+    timer1Load(t1PendOcr, t1PendShift, t1PendFastQ16);
+    ddsPhase = 0;
+#if PUMP_STEP_HW
+    if (!t1Slow && (rampActive || !ddsFrac)) TIMSK1 &= ~(1 << OCIE1A);   // был разовый
+#endif
+  } else if (!rampActive) {
+    ddsNextPeriod();
+  }
+
+#if PUMP_STEP_HW
+  // фронт пришёлся на медленный период: считаем сами (на быстром — Timer2)
+  if (stepEnable && !fastStepQ16 && (stepHalf ^= 1)) stepCount++;
+#endif
+
+#if !PUMP_STEP_HW
   if (!stepEnable) return;
 
   digitalWrite(PIN_STEP, HIGH);
   delayMicroseconds(4);
   digitalWrite(PIN_STEP, LOW);
+  stepCount++;
+#endif
+}
+
+ISR(TIMER2_COMPA_vect) {
+  PROF_SCOPE(PROF_ISR_T2);
+
+  // прошедшая мс — по ещё действующему периоду: рампа и PULSE ниже его сменят
+  if (fastStepQ16) {
+    int32_t acc = fastAccQ16 + (int32_t)fastStepQ16;
+    if (acc > 0) {
+      stepCount += (uint32_t)acc >> 16;
+      acc &= 0xFFFF;
+    }
+    fastAccQ16 = acc;
+  }
+
+  if (rampActive) rampTick();
+  if (pulseActive && --pulseLeftMs == 0) pulseGate(!pulsePhaseOn);
+
+  timer2Sync();
 }
 
 void pumpBegin() {
@@ -80,62 +564,315 @@ void pumpBegin() {
   digitalWrite(PIN_ENA, HIGH);   // ENA polarity inverted: HIGH = disabled (for your wiring)
 
   timer1Init();
+  timer2Init();
 }
 
-void pumpSetEnable(bool en) {
-  stepEnable = en;
+void pumpSetRamp(uint32_t accelStepsPerSec2, uint32_t decelStepsPerSec2) {
+  accel_sps2 = accelStepsPerSec2;
+  decel_sps2 = decelStepsPerSec2;
+}
 
-  if (en) TIMSK1 |= (1 << OCIE1A);
-  else    TIMSK1 &= ~(1 << OCIE1A);
+void pumpSetEnable(bool en) {
+  // Выключение — мгновенное (без торможения). Включение только разрешает
+  // драйвер; STEP запускают pumpStartSteps*/pumpRunCont (с разгоном).
+  if (!en) {
+    uint8_t sreg = SREG;
+    cli();
+    pulseActive = false;
+    stepTrainOff();
+    SREG = sreg;
+  }
 
   // ENA у тебя аппаратно не используется, но оставим как было
   digitalWrite(PIN_ENA, en ? LOW : HIGH);  // ENA polarity inverted: LOW=enable, HIGH=disable
 }
 
 void pumpStartSteps(uint32_t stepsPerSec) {
-  if (stepsPerSec == 0) {
+  if (stepsPerSec > PUMP_MAX_STEP_HZ) stepsPerSec = PUMP_MAX_STEP_HZ;
+  pumpStartSteps_mHz(stepsPerSec * 1000UL);
+}
+
+void pumpStartSteps_mHz(uint32_t milliStepsPerSec) {
+  if (milliStepsPerSec == 0) {
     pumpStop();
     return;
   }
-  if (stepsPerSec > 2000) stepsPerSec = 2000;
-  pumpSetRateHz((uint16_t)stepsPerSec);
-  pumpSetEnable(true);
+  digitalWrite(PIN_ENA, LOW);   // enable (inverted)
+  pumpSetTarget_mHz(milliStepsPerSec);
 }
 
 void pumpStop() {
-  stepEnable = false;
-  TIMSK1 &= ~(1 << OCIE1A);
+  uint8_t sreg = SREG;
+  cli();
+  bool idle = !running && !pulseActive;
+  pulseActive = false;
+  bool stopping = rampStop;
+  uint32_t from = stopping ? 0 : rampFreeze();
+  if (stopping) {         // уже тормозим
+    SREG = sreg;
+    return;
+  }
+  if (idle) {
+    // уже стоим: таймер не трогаем
+    SREG = sreg;
+    digitalWrite(PIN_ENA, HIGH);  // disable (inverted)
+    return;
+  }
+
+  // Торможение до стартовой частоты, потом ISR сам снимет STEP и ENA
+  if (rampBegin(from, RAMP_START_MHZ, decel_sps2)) {
+    rampStop = true;
+    SREG = sreg;
+    return;
+  }
+  SREG = sreg;
+  pumpStopNow();
+}
+
+void pumpStopNow() {
+  uint8_t sreg = SREG;
+  cli();
+  pulseActive = false;
+  stepTrainOff();
+  SREG = sreg;
   digitalWrite(PIN_ENA, HIGH);  // disable (inverted)
 }
 
+bool pumpIsRunning() {
+  return running;
+}
+
+uint32_t pumpGetStepCount() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t n = stepCount;
+  SREG = sreg;
+  return n;
+}
+
+uint32_t pumpGetReprogramCount() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t n = t1Reprograms;
+  SREG = sreg;
+  return n;
+}
+
+// Кэш пересчёта поток -> частота: loop() зовёт pumpRunCont/pumpRunPulse на
+// каждом проходе, а вход меняется редко
+static int32_t  rateFlow_x100 = -1;
+static uint32_t rateGain = 0;
+static uint32_t rate_mHz = 0;
+
+// mHz = flow_x100 / 100 * gain (шаг/мин) * 1000 / 60 = flow_x100 * gain / 6
+static uint32_t flowRate_mHz(int32_t flow_x100, uint32_t pumpGain) {
+  if (flow_x100 <= 0) return 0;
+  uint64_t mHz = ((uint64_t)flow_x100 * (uint64_t)pumpGain + 3ULL) / 6ULL;
+  if (mHz > PUMP_MAX_STEP_HZ * 1000ULL) mHz = PUMP_MAX_STEP_HZ * 1000ULL;
+  return (uint32_t)mHz;
+}
+
+static uint32_t flowToRate_mHz(int32_t flow_x100, uint32_t pumpGain) {
+  if (flow_x100 == rateFlow_x100 && pumpGain == rateGain) return rate_mHz;
+
+  rateFlow_x100 = flow_x100;
+  rateGain = pumpGain;
+  rate_mHz = flowRate_mHz(flow_x100, pumpGain);
+  return rate_mHz;
+}
+
 void pumpRunCont(int32_t flow_x100, uint32_t pumpGain) {
   if (flow_x100 <= 0 || pumpGain == 0) {
     pumpStop();
     return;
   }
 
-  // steps/min = flow * gain
-  uint64_t stepsPerMin = ((uint64_t)flow_x100 * (uint64_t)pumpGain) / 100ULL;
-  if (stepsPerMin == 0) {
+  uint32_t mHz = flowToRate_mHz(flow_x100, pumpGain);
+  if (mHz == 0) {
     pumpStop();
     return;
   }
 
-  // steps/sec (округление вверх)
-  uint32_t hz = (uint32_t)((stepsPerMin + 59ULL) / 60ULL);
-  if (hz < 1) hz = 1;
-  if (hz > 2000) hz = 2000;
+  // уже идём (или разгоняемся) к этой частоте — таймер не трогаем
+  if (running && !rampStop && !pulseActive && clampRate_mHz(mHz) == target_mHz) return;
+
+  pumpStartSteps_mHz(mHz);
+}
+
+// ===== Таблица POT -> частота/период (RUN) =====
+// Уставка линейна по АЦП, значит и частота; период (1/частота) — нет.
+// Узлы через равные отрезки АЦП: частота и период в тактах Q6, между
+// узлами — линейная интерполяция. Частота так точная, период на отрезке
+// выгнут (1/x): 32 отрезка — до ~0.2% внизу диапазона kmin..kmax 1:4.
+// Строится только при смене эпохи диапазона, дальше ни 64-битных
+// умножений, ни делений: на проход — сравнение входа с прошлым.
+static_assert((PUMP_LUT_SEGS & (PUMP_LUT_SEGS - 1)) == 0 && PUMP_LUT_SEGS >= 16 && PUMP_LUT_SEGS <= 64,
+              "PUMP_LUT_SEGS must be a power of 2 in 16..64");
+static constexpr uint8_t LUT_SHIFT = (PUMP_LUT_SEGS == 16) ? 8 : (PUMP_LUT_SEGS == 32) ? 7 : 6;  // 4096 / SEGS
+static constexpr uint8_t LUT_KNOTS = PUMP_LUT_SEGS + 1;
+
+struct LutKnot {
+  uint32_t mHz;
+  uint32_t periodQ;
+};
+
+static LutKnot lut[LUT_KNOTS];
+static bool     lutBuilt = false;
+static uint16_t lutEpoch = 0;
+static uint16_t lutAdc = 0xFFFF;   // вход, под который уже заряжен таймер
+
+void pumpLutSync(uint16_t epoch, int32_t flowMin_x100, int32_t flowMax_x100,
+                 uint32_t pumpGain, uint16_t adcMax) {
+  if (lutBuilt && epoch == lutEpoch) return;
+
+  int32_t span = flowMax_x100 - flowMin_x100;
+  if (span < 0) span = 0;
+  for (uint8_t i = 0; i < LUT_KNOTS; i++) {
+    // частота по непрерывной прямой, без округления уставки до 0.01:
+    // mHz = (flowMin + span * adc / adcMax) * gain / 6.
+    // Последний узел (4096) чуть за adcMax — та же прямая.
+    uint32_t adc = (uint32_t)i << LUT_SHIFT;
+    int64_t num = ((int64_t)flowMin_x100 * adcMax + (int64_t)span * adc) * (int64_t)pumpGain;
+    // Частота узла не зажимается (иначе отрезок через PUMP_MAX_STEP_HZ
+    // занижал бы частоту под пределом), период — для частоты, зажатой в
+    // пределы Timer1 (PUMP_MIN_STEP_MHZ..PUMP_MAX_STEP_HZ)
+    uint64_t mHz = (num <= 0) ? 0 : ((uint64_t)num + 3ULL * adcMax) / (6ULL * adcMax);
+    if (mHz > 0xFFFFFFFFULL) mHz = 0xFFFFFFFFULL;
+    lut[i].mHz = (uint32_t)mHz;
+    lut[i].periodQ = periodQFor_mHz(clampRate_mHz(lut[i].mHz));
+  }
+
+  lutBuilt = true;
+  lutEpoch = epoch;
+  lutAdc = 0xFFFF;
+}
+
+uint32_t pumpLutRate_mHz(uint16_t adc, uint32_t *periodQ) {
+  if (!lutBuilt) return 0;
+  if (adc > 4095) adc = 4095;
 
-  pumpSetRateHz((uint16_t)hz);
-  pumpSetEnable(true);
+  uint8_t i = (uint8_t)(adc >> LUT_SHIFT);
+  uint8_t f = (uint8_t)(adc & ((1U << LUT_SHIFT) - 1));
+  const LutKnot &a = lut[i];
+  const LutKnot &b = lut[i + 1];
+
+  // частота растёт с АЦП; на отрезке больше 2^24 mHz — без переполнения
+  uint32_t d = b.mHz - a.mHz;
+  uint32_t mHz = a.mHz + ((d < (1UL << 24)) ? ((d * f + (1U << (LUT_SHIFT - 1))) >> LUT_SHIFT) : ((d >> LUT_SHIFT) * f));
+
+  if (!periodQ) return mHz;
+  if (a.mHz < PUMP_MIN_STEP_MHZ || b.mHz > PUMP_MAX_STEP_HZ * 1000UL || d > (a.mHz >> 4)) {
+    // Период = 1/частота: на отрезке, где частота меняется больше чем на
+    // 1/16, прямая между периодами узлов ошибается больше 0.1% (у нижнего
+    // края пота с flowMin ~ 0 — в разы), а за пределами Timer1 узлы зажаты.
+    // Тут период считается напрямую — только при смене входа, не каждый проход
+    *periodQ = periodQFor_mHz(mHz);
+  } else {
+    // период убывает; интерполяция в тиках прескалера длинного конца
+    // (<= 2^22), чтобы произведение влезло в 32 бита
+    uint8_t sh = prescShiftFor(a.periodQ);
+    uint32_t ta = a.periodQ >> sh;
+    uint32_t tb = b.periodQ >> sh;
+    *periodQ = (ta - (((ta - tb) * f) >> LUT_SHIFT)) << sh;
+  }
+  return mHz;
+}
+
+void pumpRunContAdc(uint16_t adc) {
+  // тот же вход, мотор идёт (или разгоняется) к нему — считать нечего
+  if (adc == lutAdc && running && !rampStop && !pulseActive) return;
+
+  uint32_t periodQ;
+  uint32_t mHz = pumpLutRate_mHz(adc, &periodQ);
+  if (mHz == 0) {
+    pumpStop();
+    return;
+  }
+  lutAdc = adc;
+
+  uint32_t c = clampRate_mHz(mHz);   // periodQ уже для зажатой частоты
+  if (running && !rampStop && !pulseActive && c == target_mHz) return;
+
+  digitalWrite(PIN_ENA, LOW);   // enable (inverted)
+  pumpSetTarget(c, periodFromQ(periodQ, true));
 }
 
 void pumpRunPulse(bool &phaseOn,
                   uint32_t &phaseStartMs,
                   const Settings &S,
-                  int32_t flow_x100) {
-  (void)phaseOn;
-  (void)phaseStartMs;
-  (void)S;
-  (void)flow_x100;
+                  uint32_t rate_mHz) {
+  uint16_t onMs = S.pulse_on_ms;
+  uint16_t offMs = S.pulse_off_ms;
+  if (rate_mHz == 0 || onMs == 0) {
+    pumpStop();
+    phaseOn = false;
+    return;
+  }
+
+  // средняя частота как в CONT; по желанию ON-фаза ускоряется на (on+off)/on,
+  // чтобы среднее за цикл совпало с уставкой потенциометра
+  uint32_t rate = rate_mHz;
+  if (S.pulse_keep_avg) {
+    // пересчёт только при смене частоты или фаз
+    static uint32_t avgIn = 0, avgOut = 0;
+    static uint16_t avgOn = 0, avgOff = 0;
+    if (rate != avgIn || onMs != avgOn || offMs != avgOff) {
+      uint64_t mHz = (uint64_t)rate * ((uint32_t)onMs + offMs) / onMs;
+      avgOut = (mHz > PUMP_MAX_STEP_HZ * 1000ULL) ? PUMP_MAX_STEP_HZ * 1000UL : (uint32_t)mHz;
+      avgIn = rate;
+      avgOn = onMs;
+      avgOff = offMs;
+    }
+    rate = avgOut;
+  }
+  rate = clampRate_mHz(rate);
+
+  if (offMs == 0) {
+    // без паузы это просто непрерывная подача
+    pumpStartSteps_mHz(rate);
+    phaseOn = true;
+    return;
+  }
+
+  if (!pulseActive || rate != target_mHz || onMs != pulseOnMs || offMs != pulseOffMs) {
+    bool restart = !pulseActive || onMs != pulseOnMs || offMs != pulseOffMs;
+    TimerPeriod cruise = periodFor_mHz(rate, true);
+
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t from = 0;
+    if (restart) {
+      pulseActive = false;
+      stepTrainOff();
+    } else {
+      from = rampFreeze();
+    }
+    target_mHz = rate;
+    ddsOcr = cruise.ocr;
+    ddsShift = cruise.shift;
+    ddsFrac = cruise.frac;
+    pulseOnMs = onMs;
+    pulseOffMs = offMs;
+    if (restart) {
+      digitalWrite(PIN_ENA, LOW);   // enable (inverted)
+      pulseActive = true;
+      pulseGate(true);              // цикл начинается с ON, с разгона
+      timer2Sync();
+    } else if (pulsePhaseOn) {
+      // новая частота с текущей ON-фазы — рампой от достигнутой, как в CONT
+      bool ramp = (rate > from) ? rampBegin(from, rate, accel_sps2)
+                                : rampBegin(from, rate, decel_sps2);
+      if (!ramp) cruiseApply();
+    }
+    SREG = sreg;
+  }
+
+  // фаза для UI/отладки
+  uint8_t sreg = SREG;
+  cli();
+  bool on = pulsePhaseOn;
+  uint16_t left = pulseLeftMs;
+  SREG = sreg;
+  phaseOn = on;
+  phaseStartMs = millis() - ((on ? onMs : offMs) - left);
 }
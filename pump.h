@@ -5,8 +5,26 @@
 void pumpBegin();
 void pumpSetEnable(bool en);
 
+// Разгон/торможение, шаг/с^2 (0 = мгновенно)
+void pumpSetRamp(uint32_t accelStepsPerSec2, uint32_t decelStepsPerSec2);
+
 void pumpStartSteps(uint32_t stepsPerSec);
-void pumpStop();
+// Частота в милли-шагах/с (1000 = 1 шаг/с); дробная часть отрабатывается
+// фазовым аккумулятором, так что среднее число шагов точное
+void pumpStartSteps_mHz(uint32_t milliStepsPerSec);
+void pumpStop();      // с торможением (decel), ENA снимается в конце
+void pumpStopNow();   // мгновенно
+bool pumpIsRunning(); // true пока идут шаги (в т.ч. торможение)
+uint32_t pumpGetStepCount();      // выданные шаги с запуска (снимок, атомарно)
+uint32_t pumpGetReprogramCount(); // сколько раз менялся период Timer1 (диагностика)
 
 void pumpRunCont(int32_t flow_x100, uint32_t pumpGain);
-void pumpRunPulse(bool &phaseOn, uint32_t &phaseStartMs, const Settings &S, int32_t flow_x100);
+void pumpRunPulse(bool &phaseOn, uint32_t &phaseStartMs, const Settings &S, uint32_t rate_mHz);
+
+// Таблица POT -> частота/период STEP для RUN. Строится заново, только
+// когда epoch отличается от той, под которую построена (вход — диапазон
+// уставки flowMin..flowMax при АЦП 0..adcMax и pump_gain)
+void pumpLutSync(uint16_t epoch, int32_t flowMin_x100, int32_t flowMax_x100,
+                 uint32_t pumpGain, uint16_t adcMax);
+uint32_t pumpLutRate_mHz(uint16_t adc, uint32_t *periodQ = nullptr);  // 0 = таблицы нет
+void pumpRunContAdc(uint16_t adc);   // CONT по таблице, без 64-битной арифметики
@@ -1,4 +1,5 @@
 #include "reco.h"
+#include "fixed.h"
 
 // Baseline recommendation in abstract "u/min" (x100).
 // After calibration it will be shown as ml/min automatically.
@@ -13,7 +14,7 @@ int32_t recoGetRecFlow_x100(Material mat, uint8_t dia_mm, uint16_t al_factor_x10
   int32_t steel = recFlowSteelBase_x100(dia_mm);
   if (mat == MAT_STEEL) return steel;
 
-  int32_t al = (int32_t)((int64_t)steel * (int64_t)al_factor_x100 / 100);
+  int32_t al = Fx100::fromRaw(steel).mul(Kx100::fromRaw(al_factor_x100)).raw;
   if (al < 1) al = 1;
   return al;
 }
@@ -0,0 +1,69 @@
+#include "sched.h"
+
+static const SchedTask *tasks = nullptr;
+static uint8_t taskCount = 0;
+
+static uint8_t   order[SCHED_MAX_TASKS];    // номера задач по приоритету
+static uint32_t  nextMs[SCHED_MAX_TASKS];   // следующий запуск по расписанию
+static SchedStat stat[SCHED_MAX_TASKS];
+
+void schedBegin(const SchedTask *t, uint8_t n) {
+  if (n > SCHED_MAX_TASKS) n = SCHED_MAX_TASKS;
+
+  // вставками по prio (задач единицы)
+  for (uint8_t i = 0; i < n; i++) {
+    uint8_t j = i;
+    for (; j > 0 && t[order[j - 1]].prio > t[i].prio; j--) order[j] = order[j - 1];
+    order[j] = i;
+  }
+
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < n; i++) nextMs[i] = now;
+
+  tasks = t;
+  taskCount = n;
+  schedResetStats();
+}
+
+void schedRun() {
+  for (uint8_t k = 0; k < taskCount; k++) {
+    uint8_t i = order[k];
+    const SchedTask &t = tasks[i];
+    uint32_t now = millis();
+    if ((int32_t)(now - nextMs[i]) < 0) continue;
+
+    uint32_t release = t.periodMs ? nextMs[i] : now;
+    uint32_t t0 = micros();
+    t.fn();
+    uint32_t dt = micros() - t0;
+    uint32_t end = millis();
+
+    SchedStat &s = stat[i];
+    if (dt > s.wcetUs) s.wcetUs = (dt > 0xFFFF) ? 0xFFFF : (uint16_t)dt;
+    if (end - release > t.deadlineMs && s.missed < 0xFFFF) s.missed++;
+
+    // По расписанию, без дрейфа; отстали больше чем на период — пропущенные
+    // запуски не догоняем пачкой
+    nextMs[i] += t.periodMs;
+    if ((int32_t)(end - nextMs[i]) >= (int32_t)t.periodMs) nextMs[i] = end + t.periodMs;
+  }
+}
+
+uint8_t schedTaskCount() {
+  return taskCount;
+}
+
+const SchedTask &schedTask(uint8_t i) {
+  return tasks[i];
+}
+
+const SchedStat &schedStat(uint8_t i) {
+  return stat[i];
+}
+
+void schedResetStats() {
+  for (uint8_t i = 0; i < taskCount; i++) {
+    stat[i].wcetUs = 0;
+    stat[i].missed = 0;
+  }
+}
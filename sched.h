@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+// Кооперативный планировщик по времени: статическая таблица задач, каждая
+// со своим периодом, приоритетом и сроком. loop() только зовёт schedRun().
+// Задача не должна ждать: что не успела — доделает в следующем запуске.
+
+struct SchedTask {
+  const char *name_P;    // имя (PROGMEM) для диагностики
+  void (*fn)();
+  uint16_t periodMs;     // 0 = каждый проход loop()
+  uint16_t deadlineMs;   // от готовности (момента по расписанию) до конца выполнения
+  uint8_t  prio;         // 0 = самая срочная
+};
+
+struct SchedStat {
+  uint16_t wcetUs;       // худшее время выполнения
+  uint16_t missed;       // сколько раз закончила позже срока
+};
+
+constexpr uint8_t SCHED_MAX_TASKS = 8;
+
+// Таблица должна жить всё время работы; порядок в ней не важен — задачи
+// идут по prio (при равном — как в таблице)
+void schedBegin(const SchedTask *tasks, uint8_t n);
+
+// Из loop(): запускает все готовые задачи в порядке приоритета
+void schedRun();
+
+// i — номер задачи в таблице
+uint8_t schedTaskCount();
+const SchedTask &schedTask(uint8_t i);
+const SchedStat &schedStat(uint8_t i);
+void schedResetStats();
@@ -1,53 +1,227 @@
 #include <EEPROM.h>
+#include <string.h>
+#include <stddef.h>
+#include "config.h"
 #include "settings.h"
+#include "eestore.h"
 
 Settings S;
-static constexpr uint32_t SETTINGS_MAGIC = 0x4D514C31UL; // "MQL1"
+
+// "MQL2" + version: текущий формат. Целостность записи проверяет CRC16
+// журнала (eestore), здесь — версия и допустимые значения полей.
+static constexpr uint32_t SETTINGS_MAGIC = 0x4D514C32UL; // "MQL2"
+static constexpr uint8_t  SETTINGS_VERSION = 2;
+
+// ===== Старые форматы =====
+// v1: "MQL1", без поля version, одним блоком с адреса 0 — раскладка
+// Settings первой прошивки.
+static constexpr uint32_t SETTINGS_V1_MAGIC = 0x4D514C31UL; // "MQL1"
+
+struct SettingsV1 {
+  uint32_t magic;
+
+  UiLang   uiLang;
+  Material material;
+  uint8_t  cutter_mm;
+
+  Mode     mode;
+  uint16_t pulse_on_ms;
+  uint16_t pulse_off_ms;
+
+  uint16_t kmin_x100;
+  uint16_t kmax_x100;
+  uint16_t al_factor_x100;
+
+  uint8_t  pot_avg_N;
+  uint8_t  pot_hyst_x100;
+
+  uint32_t pump_gain_steps_per_u_min;
+  uint32_t steps_per_rev;
+
+  bool     calibrated;
+  uint32_t ml_per_u_x1000;
+
+  int32_t  last_rec_x100;
+};
+
+// Сохранение запрошено, но снимок ещё не отдан в eestore (там шла запись)
+static bool savePending = false;
+
+static void defaultsInto(Settings &s) {
+  s.magic = SETTINGS_MAGIC;
+  s.version = SETTINGS_VERSION;
+
+  s.uiLang = UILANG_EN;  // Default language: English
+  s.material = MAT_STEEL;
+  s.cutter_mm = 10;
+
+  s.mode = MODE_CONT;
+  s.pulse_on_ms = 500;
+  s.pulse_off_ms = 2000;
+
+  s.kmin_x100 = 50;       // 0.50x
+  s.kmax_x100 = 200;      // 2.00x
+  s.al_factor_x100 = 130; // Al = 1.30x Steel
+
+  s.pot_avg_N = 8;
+  s.pot_hyst_x100 = 2;    // 0.02 u/min hysteresis (in u units)
+
+  s.pump_gain_steps_per_u_min = 1000;
+  s.steps_per_rev = 3200;
+
+  s.calibrated = false;
+  s.ml_per_u_x1000 = 0;
+
+  s.last_rec_x100 = 55;
+
+  s.accel_steps_s2 = 20000;
+  s.decel_steps_s2 = 40000;
+
+  s.pulse_keep_avg = 1;
+}
 
 void settingsLoadDefaults() {
+  defaultsInto(S);
+}
+
+static_assert(sizeof(Settings) <= EE_LOG_SLOT_SIZE - 5, "Settings do not fit EEPROM log slot");
+static_assert(sizeof(SettingsV1) <= EE_LOG_SLOT_SIZE - 5, "SettingsV1 does not fit EEPROM log slot");
+
+// v1 -> v2: те же поля, добавились version, рампа и pulse_keep_avg
+// (остаются по умолчанию)
+static void migrateV1(const uint8_t *raw) {
+  SettingsV1 o;
+  memcpy(&o, raw, sizeof(o));
+
+  S.uiLang = o.uiLang;
+  S.material = o.material;
+  S.cutter_mm = o.cutter_mm;
+  S.mode = o.mode;
+  S.pulse_on_ms = o.pulse_on_ms;
+  S.pulse_off_ms = o.pulse_off_ms;
+  S.kmin_x100 = o.kmin_x100;
+  S.kmax_x100 = o.kmax_x100;
+  S.al_factor_x100 = o.al_factor_x100;
+  S.pot_avg_N = o.pot_avg_N;
+  S.pot_hyst_x100 = o.pot_hyst_x100;
+  S.pump_gain_steps_per_u_min = o.pump_gain_steps_per_u_min;
+  S.steps_per_rev = o.steps_per_rev;
+  memcpy(&S.calibrated, &o.calibrated, 1);   // проверит settingsValidate
+  S.ml_per_u_x1000 = o.ml_per_u_x1000;
+  S.last_rec_x100 = o.last_rec_x100;
+
   S.magic = SETTINGS_MAGIC;
+  S.version = 2;
+}
+
+// Поле вне диапазона -> значение по умолчанию (остальные поля не трогаем,
+// калибровка не теряется из-за одного битого байта)
+template <typename T>
+static bool fixRange(T &v, T lo, T hi, T def) {
+  if (v >= lo && v <= hi) return false;
+  v = def;
+  return true;
+}
 
-  S.uiLang = UILANG_EN;  // Default language: English
-  S.material = MAT_STEEL;
-  S.cutter_mm = 10;
+static bool settingsValidate() {
+  Settings d;
+  defaultsInto(d);
+  bool fixed = false;
 
-  S.mode = MODE_CONT;
-  S.pulse_on_ms = 500;
-  S.pulse_off_ms = 2000;
+  // Validate language (handles old EEPROM layouts / random bytes)
+  fixed |= fixRange<uint8_t>((uint8_t &)S.uiLang, UILANG_EN, UILANG_UA, d.uiLang);
+  fixed |= fixRange<uint8_t>((uint8_t &)S.material, MAT_STEEL, MAT_ALUMINUM, d.material);
+  fixed |= fixRange<uint8_t>(S.cutter_mm, 3, 50, d.cutter_mm);
+
+  fixed |= fixRange<uint8_t>((uint8_t &)S.mode, MODE_CONT, MODE_PULSE, d.mode);
+  fixed |= fixRange<uint16_t>(S.pulse_on_ms, 100, 5000, d.pulse_on_ms);
+  fixed |= fixRange<uint16_t>(S.pulse_off_ms, 100, 10000, d.pulse_off_ms);
+  fixed |= fixRange<uint8_t>(S.pulse_keep_avg, 0, 1, d.pulse_keep_avg);
+
+  fixed |= fixRange<uint16_t>(S.kmin_x100, 20, 100, d.kmin_x100);
+  fixed |= fixRange<uint16_t>(S.kmax_x100, 120, 400, d.kmax_x100);
+  fixed |= fixRange<uint16_t>(S.al_factor_x100, 100, 200, d.al_factor_x100);
 
-  S.kmin_x100 = 50;       // 0.50x
-  S.kmax_x100 = 200;      // 2.00x
-  S.al_factor_x100 = 130; // Al = 1.30x Steel
+  if (S.pot_avg_N != 4 && S.pot_avg_N != 8 && S.pot_avg_N != 16) {
+    S.pot_avg_N = d.pot_avg_N;
+    fixed = true;
+  }
+  fixed |= fixRange<uint8_t>(S.pot_hyst_x100, 0, 50, d.pot_hyst_x100);
+
+  fixed |= fixRange<uint32_t>(S.pump_gain_steps_per_u_min, 50, 50000, d.pump_gain_steps_per_u_min);
+  fixed |= fixRange<uint32_t>(S.steps_per_rev, 1, 51200, d.steps_per_rev);
 
-  S.pot_avg_N = 8;
-  S.pot_hyst_x100 = 2;    // 0.02 u/min hysteresis (in u units)
+  // bool из EEPROM может оказаться любым байтом
+  uint8_t cal;
+  memcpy(&cal, &S.calibrated, 1);
+  if (cal > 1 || (cal && (S.ml_per_u_x1000 == 0 || S.ml_per_u_x1000 > 10000000UL))) {
+    S.calibrated = false;
+    S.ml_per_u_x1000 = 0;
+    fixed = true;
+  }
 
-  S.pump_gain_steps_per_u_min = 1000;
-  S.steps_per_rev = 3200;
+  fixed |= fixRange<int32_t>(S.last_rec_x100, 1, 10000, d.last_rec_x100);
 
-  S.calibrated = false;
-  S.ml_per_u_x1000 = 0;
+  fixed |= fixRange<uint32_t>(S.accel_steps_s2, 0, 200000, d.accel_steps_s2);
+  fixed |= fixRange<uint32_t>(S.decel_steps_s2, 0, 200000, d.decel_steps_s2);
 
-  S.last_rec_x100 = 55;
+  return fixed;
 }
 
 void settingsLoad() {
-  EEPROM.get(0, S);
-  if (S.magic != SETTINGS_MAGIC) {
+  settingsLoadDefaults();
+
+  uint8_t raw[EE_LOG_SLOT_SIZE - 5];
+  uint8_t len = 0;
+  bool dirty = false;
+
+  if (!eeStoreLoad(EE_LOG_SETTINGS, raw, sizeof(raw), len)) {
+    // До журнала Settings (v1) лежали одним блоком с адреса 0
+    EEPROM.get(0, raw);
+    len = sizeof(SettingsV1);
+    dirty = true;   // перенос в журнал
+  }
+
+  uint32_t magic = 0;
+  if (len >= sizeof(magic)) memcpy(&magic, raw, sizeof(magic));
+
+  if (magic == SETTINGS_V1_MAGIC && len >= sizeof(SettingsV1)) {
+    migrateV1(raw);
+    dirty = true;
+  } else if (magic == SETTINGS_MAGIC && len > offsetof(Settings, version)) {
+    // Запись короче текущей Settings — хвост остаётся по умолчанию;
+    // длиннее (запись от более новой прошивки) — лишнее отбрасывается
+    memcpy(&S, raw, (len < sizeof(S)) ? len : sizeof(S));
+    if (S.version != SETTINGS_VERSION) {
+      S.version = SETTINGS_VERSION;
+      dirty = true;
+    }
+  } else {
+    // пустая EEPROM или неизвестный формат
     settingsLoadDefaults();
     settingsSave();
     return;
   }
 
-  // Validate language (handles old EEPROM layouts / random bytes)
-  if (S.uiLang != UILANG_EN && S.uiLang != UILANG_UA) {
-      S.uiLang = UILANG_EN;  // Reset to default if invalid
-      settingsSave();
-  }
+  if (settingsValidate()) dirty = true;
+  if (dirty) settingsSave();
 }
 
 void settingsSave() {
   S.magic = SETTINGS_MAGIC;
+  S.version = SETTINGS_VERSION;
+
+  // Снимок S копируется сразу, если eestore свободен; иначе его возьмёт
+  // settingsPoll() — уже с последними изменениями
+  savePending = !eeStoreSave(EE_LOG_SETTINGS, &S, sizeof(S));
+}
+
+void settingsPoll() {
+  if (savePending && !eeStoreBusy()) {
+    savePending = !eeStoreSave(EE_LOG_SETTINGS, &S, sizeof(S));
+  }
+}
 
-  EEPROM.put(0, S);
+bool settingsSavePending() {
+  return savePending || eeStoreBusy();
 }
@@ -4,5 +4,7 @@
 extern Settings S;
 
 void settingsLoad();
-void settingsSave();
+void settingsSave();    // не блокирует: запись идёт в фоне (EE_READY)
+void settingsPoll();    // из loop(): дописать отложенное сохранение
+bool settingsSavePending();
 void settingsLoadDefaults();
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Перекодирует tools/ui_text_ua.utf8.h (UTF-8) в ui_text_ua.h с байтами
+знакогенератора HD44780 (кириллический ROM модуля LCD2004), чтобы на MCU не
+было разбора UTF-8. Таблица — по результатам LCD теста (меню "LCD test").
+
+    python3 tools/gen_ui_text_ua.py
+"""
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SRC = os.path.join(HERE, "ui_text_ua.utf8.h")
+DST = os.path.join(HERE, "..", "ui_text_ua.h")
+
+# Unicode -> код LCD. Буквы, совпадающие по виду с латиницей, берутся из ASCII.
+LCD = {
+    "А": 0x41, "Б": 0xA0, "В": 0x42, "Г": 0xA1, "Д": 0x44, "Е": 0x45, "Ё": 0x45,
+    "Ж": 0xA3, "З": 0xA4, "И": 0xA5, "Й": 0xA6, "К": 0x4B, "Л": 0xA7, "М": 0x4D,
+    "Н": 0x48, "О": 0x4F, "П": 0xA8, "Р": 0x50, "С": 0x43, "Т": 0x54, "У": 0xA9,
+    "Ф": 0xAA, "Х": 0x58, "Ц": 0x43, "Ч": 0xAB, "Ш": 0xAC, "Щ": 0xAC, "Ъ": 0xAD,
+    "Ы": 0xAE, "Ь": 0x62, "Э": 0xAF, "Ю": 0xB0, "Я": 0xB1,
+    "а": 0x61, "б": 0xB2, "в": 0xB3, "г": 0xB4, "д": 0x64, "е": 0x65, "ё": 0xB5,
+    "ж": 0xB6, "з": 0xB7, "и": 0xB8, "й": 0xB9, "к": 0xBA, "л": 0xBB, "м": 0xBC,
+    "н": 0xBD, "о": 0x6F, "п": 0xBE, "р": 0x70, "с": 0x63, "т": 0xBF, "у": 0x79,
+    "ф": 0xAA, "х": 0x78, "ц": 0x63, "ч": 0xC0, "ш": 0xC1, "щ": 0xC1, "ъ": 0xC2,
+    "ы": 0xC3, "ь": 0xC4, "э": 0xC5, "ю": 0xC6, "я": 0xC7,
+}
+
+STR_RE = re.compile(r'^(static const char \w+\[\] PROGMEM = )"((?:[^"\\]|\\.)*)";\s*$')
+
+
+def encode(text, where):
+    out = []
+    for ch in text:
+        if ord(ch) < 0x80:
+            out.append(ch)
+        elif ch in LCD and LCD[ch] < 0x80:
+            out.append(chr(LCD[ch]))
+        elif ch in LCD:
+            # восьмеричный escape: не "съедает" следующую цифру/букву, как \x
+            out.append("\\%03o" % LCD[ch])
+        else:
+            sys.exit("%s: no LCD code for %r" % (where, ch))
+    return "".join(out)
+
+
+def main():
+    with open(SRC, encoding="utf-8") as f:
+        lines = f.read().splitlines()
+
+    out = [
+        "// СГЕНЕРИРОВАНО tools/gen_ui_text_ua.py из tools/ui_text_ua.utf8.h — не править руками.",
+        "// Строки уже в кодах знакогенератора LCD (в комментарии — исходный текст).",
+    ]
+    for n, line in enumerate(lines, 1):
+        m = STR_RE.match(line)
+        if not m:
+            if line.startswith("// ИСХОДНИК") or line.startswith("// знакогенератора") \
+                    or line.startswith("//   python3"):
+                continue
+            out.append(line)
+            continue
+        text = m.group(2)
+        out.append('%s"%s"; // %s' % (m.group(1), encode(text, "%s:%d" % (SRC, n)), text))
+
+    with open(DST, "w", encoding="utf-8", newline="\n") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,118 @@
+#include "config.h"
+#include "totalizer.h"
+#include "settings.h"
+#include "pump.h"
+#include "eestore.h"
+
+// Общий счёт — свой журнал eestore, отдельно от Settings: пишется после
+// каждой работы и не должен утаскивать с собой несохранённые правки меню.
+// Слоты по кругу делят износ, CRC отсекает запись, оборванную питанием.
+
+static_assert(sizeof(uint32_t) <= EE_TOTAL_SLOT_SIZE - 5, "oil total does not fit its log slot");
+
+static uint32_t lifetimeMl_x100 = 0;
+
+static uint32_t jobStartSteps = 0;
+static uint32_t jobSteps = 0;       // последней завершённой работы
+static bool     jobActive = false;
+static bool     jobPending = false; // остановлена, насос ещё тормозит
+static bool     totalDirty = false; // общий счёт ещё не записан (EEPROM занята)
+
+void totalizerBegin() {
+  uint32_t ml = 0;
+  uint8_t len = 0;
+  lifetimeMl_x100 = 0;
+  if (eeStoreLoad(EE_LOG_TOTAL, &ml, sizeof(ml), len) && len == sizeof(ml)) {
+    lifetimeMl_x100 = ml;
+  }
+}
+
+// ml x100 = (steps * M + 10 * (gain / 2)) / D, M = ml_per_u_x1000, D = 10 * gain
+// (то же, что округление steps * M / 10 до целых gain). Счёт шагов работы
+// только растёт, и UI спрашивает его каждые 10 мс: частное и остаток
+// двигаются на прирост шагов одним 32-битным делением. 64 бита — только с
+// нуля: новая работа, другая калибровка или прирост больше порции
+static uint32_t convM = 0, convD = 0;
+static uint32_t convChunk = 0;      // шагов, при которых n * M + остаток < 2^32
+static uint32_t convSteps = 0, convQ = 0, convR = 0;
+static bool     convValid = false;
+
+int32_t totalizerStepsToMl_x100(const Settings &S, uint32_t steps) {
+  if (!S.calibrated || S.pump_gain_steps_per_u_min == 0) return -1;
+
+  uint32_t m = S.ml_per_u_x1000;
+  uint32_t d = S.pump_gain_steps_per_u_min * 10UL;
+  if (m != convM || d != convD) {
+    convM = m;
+    convD = d;
+    convChunk = m ? (0xFFFFFFFFUL - d) / m : 0xFFFFFFFFUL;
+    convValid = false;              // пересчёт с нуля
+  }
+
+  uint32_t n = steps - convSteps;
+  if (convValid && steps >= convSteps && n <= convChunk) {
+    uint32_t num = n * m + convR;
+    convQ += num / d;
+    convR = num % d;
+    if (convQ > 0x7FFFFFFFUL) convQ = 0x7FFFFFFFUL;
+  } else {
+    uint64_t num = (uint64_t)steps * m + S.pump_gain_steps_per_u_min / 2 * 10UL;
+    uint64_t q = num / d;
+    convQ = (q > 0x7FFFFFFFULL) ? 0x7FFFFFFFUL : (uint32_t)q;
+    convR = (uint32_t)(num % d);
+  }
+  convSteps = steps;
+  convValid = true;
+  return (convQ > 0x7FFFFFFFUL) ? 0x7FFFFFFFL : (int32_t)convQ;
+}
+
+// Работа закончена: её шаги — в общий счёт
+static void jobFinish() {
+  jobSteps = pumpGetStepCount() - jobStartSteps;
+  jobActive = false;
+  jobPending = false;
+
+  int32_t ml = totalizerStepsToMl_x100(S, jobSteps);
+  if (ml > 0) {
+    lifetimeMl_x100 += (uint32_t)ml;
+    totalDirty = true;
+  }
+}
+
+void totalizerJobStart() {
+  // прошлая работа ещё тормозит (или не остановлена): иначе её шаги
+  // затрутся новым стартом и не попадут в общий счёт
+  if (jobActive || jobPending) jobFinish();
+
+  jobStartSteps = pumpGetStepCount();
+  jobSteps = 0;
+  jobActive = true;
+  jobPending = false;
+}
+
+void totalizerJobStop() {
+  if (!jobActive) return;
+  jobActive = false;
+  jobPending = true;
+}
+
+uint32_t totalizerJobSteps() {
+  if (jobActive || jobPending) return pumpGetStepCount() - jobStartSteps;
+  return jobSteps;
+}
+
+int32_t totalizerJobMl_x100(const Settings &S) {
+  return totalizerStepsToMl_x100(S, totalizerJobSteps());
+}
+
+uint32_t totalizerLifetimeMl_x100() {
+  return lifetimeMl_x100;
+}
+
+void totalizerPoll() {
+  if (jobPending && !pumpIsRunning()) jobFinish();
+
+  if (totalDirty && eeStoreSave(EE_LOG_TOTAL, &lifetimeMl_x100, sizeof(lifetimeMl_x100))) {
+    totalDirty = false;
+  }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+#include "types.h"
+
+// Учёт вылитого масла по реально выданным шагам насоса (pumpGetStepCount)
+void totalizerBegin();
+
+void totalizerJobStart();
+void totalizerJobStop();   // объём дописывается в общий счёт, когда насос встанет
+void totalizerPoll();      // из loop()
+
+uint32_t totalizerJobSteps();
+// мл x100; -1 если нет калибровки
+int32_t  totalizerJobMl_x100(const Settings &S);
+uint32_t totalizerLifetimeMl_x100();
+
+// Шаги -> мл x100 по калибровке (ml_per_u_x1000, 1 u = pump_gain шагов); -1 без калибровки
+int32_t  totalizerStepsToMl_x100(const Settings &S, uint32_t steps);
@@ -38,13 +38,16 @@ enum AppState : uint8_t {
   ST_WIZ_DIA,
   ST_WIZ_REC,
   ST_CAL_RUN,
-  ST_CAL_INPUT
+  ST_CAL_INPUT,
+  ST_DIAG         // профайлер (PROF_ENABLE)
 };
 
-// Структура настроек
+// Структура настроек.
+// Layout версионирован (settings.cpp): новые поля — только в конец, с
+// увеличением SETTINGS_VERSION и шагом миграции.
 struct Settings {
   uint32_t magic;
-
+  uint8_t  version;
 
   UiLang   uiLang;
   Material material;
@@ -68,6 +71,13 @@ struct Settings {
   uint32_t ml_per_u_x1000;
 
   int32_t  last_rec_x100;
+
+  // Разгон/торможение насоса, шаг/с^2 (0 = без рампы)
+  uint32_t accel_steps_s2;
+  uint32_t decel_steps_s2;
+
+  // PULSE: 1 = ON-фаза ускоряется на (on+off)/on, среднее = уставке
+  uint8_t  pulse_keep_avg;
 };
 
 // Структура событий энкодера
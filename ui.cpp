@@ -1,31 +1,27 @@
-#include <Wire.h>
-#include <LiquidCrystal_I2C.h>
 #include <string.h>
 #include <stdio.h>
 
 #include "config.h"
+#include "lcd_async.h"
 #include "ui.h"
 #include "ui_print.h"
 #include "ui_text_en.h"
 #include "ui_text_ua.h"
 #include "settings.h"
+#include "prof.h"
+#include "fixed.h"
 #include <avr/pgmspace.h>
 
-// Helper function to get string from PROGMEM based on language
-static void uiStrFromProgmem(char* buf, size_t bufSize, const char* enStr, const char* uaStr) {
-  const char* selected = (S.uiLang == UILANG_UA) ? uaStr : enStr;
-  strncpy_P(buf, selected, bufSize - 1);
-  buf[bufSize - 1] = '\0';
-}
-
 // Helper macro to select string pointer based on language (for use in functions that handle PROGMEM)
 #define UI_STR_PTR(en, ua) ((S.uiLang == UILANG_UA) ? (ua) : (en))
 
 // === LCD instance ===
-LiquidCrystal_I2C lcd(LCD_I2C_ADDR, 20, 4);
+LcdAsync lcd(LCD_I2C_ADDR, 20, 4);
 
 // === cache last drawn lines ===
-static char last4[4][21];
+static char last4[4][21];   // что сейчас на LCD
+static char want4[4][21];   // что должно быть (статичный текст + поля)
+static uint8_t rowDirty = 0; // бит r: want4[r] мог разойтись с last4[r]
 static bool lastValid = false;
 
 static void setLastBlank() {
@@ -36,56 +32,239 @@ static void setLastBlank() {
   lastValid = true;
 }
 
-static void pad20(char out[21], const char* s) {
-  uint8_t i = 0;
-  for (; i < 20 && s[i]; i++) out[i] = s[i];
-  for (; i < 20; i++) out[i] = ' ';
-  out[20] = '\0';
-}
-
-// Pad20 from PROGMEM - convert UTF-8 to single-byte encoding for LCD
-static void pad20_P(char out[21], const char* s_P) {
-  // Read from PROGMEM into temp buffer
-  char temp[64];
-  uint8_t i = 0;
-  for (; i < sizeof(temp) - 1; i++) {
-    char c = pgm_read_byte(s_P + i);
-    if (c == '\0') break;
-    temp[i] = c;
-  }
-  temp[i] = '\0';
-  
-  // Convert UTF-8 to LCD encoding
-  char converted[64];
-  uiConvertUtf8ToAscii(converted, temp, sizeof(converted));
-  
-  // Pad to 20 chars
-  for (i = 0; i < 20 && converted[i] != '\0'; i++) {
-    out[i] = converted[i];
-  }
-  for (; i < 20; i++) out[i] = ' ';
-  out[20] = '\0';
+// === счётчик байт на LCD (данные + команды) ===
+// Через PCF8574 каждый байт HD44780 — два полубайта по 3 транзакции I2C,
+// ~1.2 мс шины на 100 кГц, так что это и есть основная цена кадра.
+static constexpr uint8_t LCD_SETCURSOR_BYTES = 1;  // setCursor = одна команда
+static uint32_t lcdBytesTotal = 0;
+static uint16_t lcdFrameBytes = 0;
+static uint16_t lcdLastFrameBytes = 0;
+
+// Кадр не влез в бюджет/очередь: недописанные символы остались в last4
+// старыми и уйдут следующим кадром
+static bool frameCut = false;
+
+// Перерисовка по событию: кто-то поменял то, что на экране (uiInvalidate),
+// кадр строится не чаще UI_MIN_FRAME_MS
+static bool uiInvalid = true;
+static uint32_t uiFrameMs = 0;
+
+static void frameDone() {
+  uiInvalid = false;
+  uiFrameMs = millis();
 }
 
+// Шлём только изменённые символы. Курсор HD44780 после записи сам сдвигается
+// вправо, поэтому короткий неизменённый промежуток между изменениями дешевле
+// переписать, чем перепрыгнуть через setCursor.
 static void drawRow(uint8_t row, const char line[21]) {
   if (!lastValid) setLastBlank();
-  if (memcmp(last4[row], line, 20) == 0) return;
+  char *old = last4[row];
 
-  lcd.setCursor(0, row);
-  // Write bytes directly to LCD (like in LCD test)
+  uint8_t cur = 0xFF;   // куда сейчас указывает курсор (0xFF = не в этой строке)
   for (uint8_t i = 0; i < 20; i++) {
-    lcd.write((uint8_t)line[i]);
+    if (old[i] == line[i]) continue;
+
+    // худший случай: setCursor + промежуток + символ
+    uint8_t need = LCD_SETCURSOR_BYTES + LCD_SETCURSOR_BYTES + 1;
+    if (frameCut || lcdFrameBytes + need > LCD_LOOP_BUDGET || lcd.txFree() < need) {
+      frameCut = true;
+      return;
+    }
+
+    if (cur > i || (uint8_t)(i - cur) > LCD_SETCURSOR_BYTES) {
+      lcd.setCursor(i, row);
+      lcdFrameBytes += LCD_SETCURSOR_BYTES;
+      cur = i;
+    }
+    // промежуток (если есть) и сам изменённый символ
+    for (; cur <= i; cur++) {
+      lcd.write((uint8_t)line[cur]);
+      old[cur] = line[cur];
+      lcdFrameBytes++;
+    }
   }
+}
 
-  memcpy(last4[row], line, 21);
+// Отправка кадра: diff только по строкам, где что-то менялось.
+// Строка, обрезанная бюджетом, остаётся грязной до следующего кадра.
+static void uiFlush() {
+  PROF_SCOPE(PROF_LCD_DIFF);
+
+  lcdFrameBytes = 0;
+  frameCut = false;
+  for (uint8_t r = 0; r < 4; r++) {
+    if (!(rowDirty & (1 << r))) continue;
+    drawRow(r, want4[r]);
+    if (frameCut) break;
+    rowDirty &= ~(1 << r);
+  }
+  lcdLastFrameBytes = lcdFrameBytes;
+  lcdBytesTotal += lcdFrameBytes;
+  frameDone();
+}
+
+static void setRow(uint8_t row, const char line[21]) {
+  if (memcmp(want4[row], line, 20) == 0) return;
+  memcpy(want4[row], line, 20);
+  want4[row][20] = '\0';
+  rowDirty |= 1 << row;
 }
 
 static void draw4(const char l0[21], const char l1[21],
                   const char l2[21], const char l3[21]) {
-  drawRow(0, l0);
-  drawRow(1, l1);
-  drawRow(2, l2);
-  drawRow(3, l3);
+  setRow(0, l0);
+  setRow(1, l1);
+  setRow(2, l2);
+  setRow(3, l3);
+  uiFlush();
+}
+
+void uiInvalidate() {
+  uiInvalid = true;
+}
+
+bool uiRedrawDue() {
+  if (lcd.busy()) return false;          // прошлый кадр ещё в очереди
+  if (frameCut) return true;             // обрезанный кадр дорисовываем сразу
+  return uiInvalid && (millis() - uiFrameMs >= UI_MIN_FRAME_MS);
+}
+
+uint16_t uiGetLastFrameBytes() {
+  return lcdLastFrameBytes;
+}
+
+uint32_t uiGetLcdBytesTotal() {
+  return lcdBytesTotal;
+}
+
+uint32_t uiGetLcdCmdTotal() {
+  return lcd.commandCount();
+}
+
+// === Экраны: статичный текст + поля ===
+// Подписи и подсказки кладутся в want4 один раз при входе на экран. Потом
+// каждый проход сравнивает только значения полей: изменившееся поле
+// форматируется и переписывает свои колонки, остальное не трогается.
+enum UiScreen : uint8_t {
+  SCR_NONE = 0,
+  SCR_READY,
+  SCR_WIZ_MAT,
+  SCR_WIZ_DIA,
+  SCR_WIZ_REC,
+  SCR_RUN,
+  SCR_MENU,
+  SCR_CAL_RUN,
+  SCR_CAL_INPUT,
+  SCR_LCD_TEST,
+  SCR_DIAG
+};
+
+enum UiFieldKind : uint8_t {
+  UF_X100,   // фикс. точка 0.01 ("12.34"), прижато вправо
+  UF_INT,    // целое (мм, секунды обратного отсчёта, POT), вправо
+  UF_TEXT    // подпись из PROGMEM по значению перечисления, влево
+};
+
+struct UiField {
+  uint8_t row, col, width;
+  UiFieldKind kind;
+  int32_t shown;     // значение, которое сейчас в want4
+};
+
+static constexpr uint8_t UI_MAX_FIELDS = 6;
+static constexpr int32_t UF_UNSET = -2147483647L - 1;  // ни одно значение с ним не совпадёт
+
+static UiField fields[UI_MAX_FIELDS];
+static uint8_t fieldCount = 0;
+static UiScreen screen = SCR_NONE;
+static uint8_t screenKey = 0;     // язык + вариант раскладки
+
+// true: экран сменился (или язык/вариант) — вызывающий рисует статичный
+// текст и объявляет поля заново
+static bool screenEnter(UiScreen s, uint8_t variant = 0) {
+  uint8_t key = (uint8_t)((S.uiLang << 4) | variant);
+  if (screen == s && screenKey == key) return false;
+
+  screen = s;
+  screenKey = key;
+  fieldCount = 0;
+  for (uint8_t r = 0; r < 4; r++) {
+    memset(want4[r], ' ', 20);
+    want4[r][20] = '\0';
+  }
+  rowDirty = 0x0F;
+  return true;
+}
+
+// Статичный текст из PROGMEM с колонки col; возвращает колонку после него
+static uint8_t putP(uint8_t row, uint8_t col, const char* s_P) {
+  for (; col < 20; col++, s_P++) {
+    char c = pgm_read_byte(s_P);
+    if (c == '\0') break;
+    want4[row][col] = c;
+  }
+  return col;
+}
+
+// Поле шириной width с колонки col (номер поля = порядок объявления)
+static uint8_t addField(uint8_t row, uint8_t col, uint8_t width, UiFieldKind kind) {
+  if (col > 20) col = 20;
+  if (width > 20 - col) width = 20 - col;
+  if (fieldCount < UI_MAX_FIELDS) {
+    UiField &f = fields[fieldCount++];
+    f.row = row;
+    f.col = col;
+    f.width = width;
+    f.kind = kind;
+    f.shown = UF_UNSET;
+  }
+  return col + width;
+}
+
+static uint8_t maxLenP(const char* a_P, const char* b_P) {
+  uint8_t a = strlen_P(a_P), b = strlen_P(b_P);
+  return (a > b) ? a : b;
+}
+
+static bool fieldChanged(uint8_t i, int32_t v) {
+  if (i >= fieldCount || fields[i].shown == v) return false;
+  fields[i].shown = v;
+  return true;
+}
+
+static void fieldPut(uint8_t i, const char* txt) {
+  const UiField &f = fields[i];
+  char *dst = &want4[f.row][f.col];
+  uint8_t n = strlen(txt);
+  if (n > f.width) n = f.width;
+  uint8_t pad = (f.kind == UF_TEXT) ? 0 : (uint8_t)(f.width - n);
+
+  memset(dst, ' ', f.width);
+  memcpy(dst + pad, txt, n);
+  rowDirty |= 1 << f.row;
+}
+
+static void fieldX100(uint8_t i, int32_t v_x100) {
+  if (!fieldChanged(i, v_x100)) return;
+  char b[FIXED_FMT_BUF];
+  Fx100::fromRaw(v_x100).format(b);
+  fieldPut(i, b);
+}
+
+static void fieldInt(uint8_t i, int32_t v) {
+  if (!fieldChanged(i, v)) return;
+  char b[12];
+  snprintf(b, sizeof(b), "%ld", (long)v);
+  fieldPut(i, b);
+}
+
+static void fieldText(uint8_t i, uint8_t v, const char* s_P) {
+  if (!fieldChanged(i, v)) return;
+  char b[21];
+  strncpy_P(b, s_P, sizeof(b) - 1);
+  b[sizeof(b) - 1] = '\0';
+  fieldPut(i, b);
 }
 
 // Create custom Cyrillic characters for LCD (8 custom chars max)
@@ -122,421 +301,366 @@ static void createCyrillicChars() {
 
 // === init / clear ===
 void uiBegin() {
-  Wire.begin();
   lcd.init();
   lcd.backlight();
   uiPrintInit(&lcd);
   // Try to create custom Cyrillic chars (may not work on all displays)
   // createCyrillicChars();
-  lcd.clear();
+  // init() уже очистил экран
   lastValid = false;
   setLastBlank();
+  screen = SCR_NONE;   // статичный текст экрана нарисуется заново
+  rowDirty = 0;
+  uiInvalid = true;
 }
 
+// Смена экрана без lcd.clear(): last4 по-прежнему отражает LCD, новый экран
+// просто перепишет отличающиеся символы. Clear занял бы ~1.6 мс у HD44780
+// и давал бы мигание.
 void uiClear() {
-  lcd.clear();
-  lastValid = false;
-  setLastBlank();
+  screen = SCR_NONE;   // статичный текст экрана нарисуется заново
+  rowDirty = 0;
+  uiInvalid = true;
 }
 
 // === helpers ===
-static void matStr(char* buf, size_t bufSize, const Settings &S) {
-  if (S.material == MAT_STEEL) {
-    uiStrFromProgmem(buf, bufSize, UI_STR_STEEL_EN, UI_STR_STEEL_UA);
-  } else {
-    uiStrFromProgmem(buf, bufSize, UI_STR_ALUMINUM_EN, UI_STR_ALUMINUM_UA);
-  }
+static const char* matStr_P(const Settings &S) {
+  return (S.material == MAT_STEEL) ? UI_STR_PTR(UI_STR_STEEL_EN, UI_STR_STEEL_UA)
+                                   : UI_STR_PTR(UI_STR_ALUMINUM_EN, UI_STR_ALUMINUM_UA);
 }
 
-static void modeStr(char* buf, size_t bufSize, const Settings &S) {
-  if (S.mode == MODE_CONT) {
-    uiStrFromProgmem(buf, bufSize, UI_STR_CONT_EN, UI_STR_CONT_UA);
-  } else {
-    uiStrFromProgmem(buf, bufSize, UI_STR_PULSE_EN, UI_STR_PULSE_UA);
-  }
+static const char* modeStr_P(const Settings &S) {
+  return (S.mode == MODE_CONT) ? UI_STR_PTR(UI_STR_CONT_EN, UI_STR_CONT_UA)
+                               : UI_STR_PTR(UI_STR_PULSE_EN, UI_STR_PULSE_UA);
+}
+
+static uint8_t matWidth() {
+  return maxLenP(UI_STR_PTR(UI_STR_STEEL_EN, UI_STR_STEEL_UA),
+                 UI_STR_PTR(UI_STR_ALUMINUM_EN, UI_STR_ALUMINUM_UA));
+}
+
+static uint8_t modeWidth() {
+  return maxLenP(UI_STR_PTR(UI_STR_CONT_EN, UI_STR_CONT_UA),
+                 UI_STR_PTR(UI_STR_PULSE_EN, UI_STR_PULSE_UA));
+}
+
+// "OK:Next  MENU:Back" — общая нижняя строка мастера
+static void putWizFooter() {
+  uint8_t c = putP(3, 0, UI_STR_PTR(UI_STR_OK_NEXT_EN, UI_STR_OK_NEXT_UA));
+  putP(3, c + 2, UI_STR_PTR(UI_STR_MENU_BACK_EN, UI_STR_MENU_BACK_UA));
 }
 
 // === READY ===
+// Mat:<материал>  D<мм>mm
+// Mode:<режим>
 void uiDrawReady(const Settings &S) {
-  char l0[21], l1[21], l2[21], l3[21];
+  enum { F_MAT, F_DIA, F_MODE };
 
-  pad20_P(l0, UI_STR_PTR(UI_STR_READY_EN, UI_STR_READY_UA));
-
-  {
-    char b[32];
-    char matLabelBuf[16], matBuf[16], mmUnitBuf[8];
-    uiStrFromProgmem(matLabelBuf, sizeof(matLabelBuf), UI_STR_MAT_EN, UI_STR_MAT_UA);
-    matStr(matBuf, sizeof(matBuf), S);
-    uiStrFromProgmem(mmUnitBuf, sizeof(mmUnitBuf), UI_STR_MM_EN, UI_STR_MM_UA);
-    snprintf(b, sizeof(b), "%s%s  D%u%s", matLabelBuf, matBuf, (unsigned)S.cutter_mm, mmUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
-  }
+  if (screenEnter(SCR_READY)) {
+    putP(0, 0, UI_STR_PTR(UI_STR_READY_EN, UI_STR_READY_UA));
+
+    uint8_t c = putP(1, 0, UI_STR_PTR(UI_STR_MAT_EN, UI_STR_MAT_UA));
+    c = addField(1, c, matWidth(), UF_TEXT);
+    c = putP(1, c, PSTR("  D"));
+    c = addField(1, c, 2, UF_INT);
+    putP(1, c, UI_STR_PTR(UI_STR_MM_EN, UI_STR_MM_UA));
 
-  {
-    char b[32];
-    char modeLabelBuf[16], modeBuf[16];
-    uiStrFromProgmem(modeLabelBuf, sizeof(modeLabelBuf), UI_STR_MODE_EN, UI_STR_MODE_UA);
-    modeStr(modeBuf, sizeof(modeBuf), S);
-    snprintf(b, sizeof(b), "%s%s", modeLabelBuf, modeBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l2, converted);
+    c = putP(2, 0, UI_STR_PTR(UI_STR_MODE_EN, UI_STR_MODE_UA));
+    addField(2, c, modeWidth(), UF_TEXT);
+
+    putP(3, 0, UI_STR_PTR(UI_STR_OK_MENU_START_EN, UI_STR_OK_MENU_START_UA));
   }
 
-  pad20_P(l3, UI_STR_PTR(UI_STR_OK_MENU_START_EN, UI_STR_OK_MENU_START_UA));
-  draw4(l0, l1, l2, l3);
+  fieldText(F_MAT, S.material, matStr_P(S));
+  fieldInt(F_DIA, S.cutter_mm);
+  fieldText(F_MODE, S.mode, modeStr_P(S));
+  uiFlush();
 }
 
 // === WIZARD ===
 void uiDrawWizMaterial(const Settings &S) {
-  char l0[21], l1[21], l2[21], l3[21];
-
-  pad20_P(l0, UI_STR_PTR(UI_STR_WIZ_MAT_EN, UI_STR_WIZ_MAT_UA));
-
-  {
-    char b[32];
-    char matBuf[16];
-    matStr(matBuf, sizeof(matBuf), S);
-    snprintf(b, sizeof(b), "> %s", matBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
+  enum { F_MAT };
+
+  if (screenEnter(SCR_WIZ_MAT)) {
+    putP(0, 0, UI_STR_PTR(UI_STR_WIZ_MAT_EN, UI_STR_WIZ_MAT_UA));
+    uint8_t c = putP(1, 0, PSTR("> "));
+    addField(1, c, matWidth(), UF_TEXT);
+    putP(2, 0, UI_STR_PTR(UI_STR_TURN_CHANGE_EN, UI_STR_TURN_CHANGE_UA));
+    putWizFooter();
   }
 
-  pad20_P(l2, UI_STR_PTR(UI_STR_TURN_CHANGE_EN, UI_STR_TURN_CHANGE_UA));
-  {
-    char b[32];
-    char okNextBuf[16], menuBackBuf[16];
-    uiStrFromProgmem(okNextBuf, sizeof(okNextBuf), UI_STR_OK_NEXT_EN, UI_STR_OK_NEXT_UA);
-    uiStrFromProgmem(menuBackBuf, sizeof(menuBackBuf), UI_STR_MENU_BACK_EN, UI_STR_MENU_BACK_UA);
-    snprintf(b, sizeof(b), "%s  %s", okNextBuf, menuBackBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l3, converted);
-  }
-  draw4(l0, l1, l2, l3);
+  fieldText(F_MAT, S.material, matStr_P(S));
+  uiFlush();
 }
 
 void uiDrawWizDiameter(const Settings &S) {
-  char l0[21], l1[21], l2[21], l3[21];
-
-  pad20_P(l0, UI_STR_PTR(UI_STR_WIZ_DIA_EN, UI_STR_WIZ_DIA_UA));
-
-  {
-    char b[32];
-    char mmUnitBuf[8];
-    uiStrFromProgmem(mmUnitBuf, sizeof(mmUnitBuf), UI_STR_MM_EN, UI_STR_MM_UA);
-    snprintf(b, sizeof(b), "> %u%s", (unsigned)S.cutter_mm, mmUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
+  enum { F_DIA };
+
+  if (screenEnter(SCR_WIZ_DIA)) {
+    putP(0, 0, UI_STR_PTR(UI_STR_WIZ_DIA_EN, UI_STR_WIZ_DIA_UA));
+    uint8_t c = putP(1, 0, PSTR("> "));
+    c = addField(1, c, 2, UF_INT);
+    putP(1, c, UI_STR_PTR(UI_STR_MM_EN, UI_STR_MM_UA));
+    putP(2, 0, UI_STR_PTR(UI_STR_TURN_CHANGE_EN, UI_STR_TURN_CHANGE_UA));
+    putWizFooter();
   }
 
-  pad20_P(l2, UI_STR_PTR(UI_STR_TURN_CHANGE_EN, UI_STR_TURN_CHANGE_UA));
-  {
-    char b[32];
-    char okNextBuf[16], menuBackBuf[16];
-    uiStrFromProgmem(okNextBuf, sizeof(okNextBuf), UI_STR_OK_NEXT_EN, UI_STR_OK_NEXT_UA);
-    uiStrFromProgmem(menuBackBuf, sizeof(menuBackBuf), UI_STR_MENU_BACK_EN, UI_STR_MENU_BACK_UA);
-    snprintf(b, sizeof(b), "%s  %s", okNextBuf, menuBackBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l3, converted);
-  }
-  draw4(l0, l1, l2, l3);
+  fieldInt(F_DIA, S.cutter_mm);
+  uiFlush();
 }
 
+// Rec: <x.xx> u
+// Set: <x.xx> u
+// POT:<min>..<max>
 void uiDrawWizRecommend(const Settings &S,
                         int32_t rec_u_x100,
                         int32_t set_u_x100,
                         int32_t potMin_u_x100,
                         int32_t potMax_u_x100) {
-  char l0[21], l1[21], l2[21], l3[21];
+  enum { F_REC, F_SET, F_POTMIN, F_POTMAX };
 
-  pad20_P(l0, UI_STR_PTR(UI_STR_WIZ_REC_EN, UI_STR_WIZ_REC_UA));
-
-  {
-    char b[32];
-    char uUnitBuf[8];
-    uiStrFromProgmem(uUnitBuf, sizeof(uUnitBuf), UI_STR_U_EN, UI_STR_U_UA);
-    snprintf(b, sizeof(b), "Rec: %ld.%02ld %s",
-             (long)(rec_u_x100 / 100),
-             (long)(abs(rec_u_x100) % 100),
-             uUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
-  }
+  if (screenEnter(SCR_WIZ_REC)) {
+    putP(0, 0, UI_STR_PTR(UI_STR_WIZ_REC_EN, UI_STR_WIZ_REC_UA));
 
-  {
-    char b[32];
-    char uUnitBuf[8];
-    uiStrFromProgmem(uUnitBuf, sizeof(uUnitBuf), UI_STR_U_EN, UI_STR_U_UA);
-    snprintf(b, sizeof(b), "Set: %ld.%02ld %s",
-             (long)(set_u_x100 / 100),
-             (long)(abs(set_u_x100) % 100),
-             uUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l2, converted);
-  }
+    uint8_t c = putP(1, 0, PSTR("Rec: "));
+    c = addField(1, c, 6, UF_X100);
+    putP(1, c + 1, UI_STR_PTR(UI_STR_U_EN, UI_STR_U_UA));
+
+    c = putP(2, 0, PSTR("Set: "));
+    c = addField(2, c, 6, UF_X100);
+    putP(2, c + 1, UI_STR_PTR(UI_STR_U_EN, UI_STR_U_UA));
 
-  {
-    char b[32];
-    snprintf(b, sizeof(b), "POT:%ld..%ld",
-             (long)(potMin_u_x100 / 100),
-             (long)(potMax_u_x100 / 100));
-    pad20(l3, b);
+    c = putP(3, 0, PSTR("POT:"));
+    c = addField(3, c, 3, UF_INT);
+    c = putP(3, c, PSTR(".."));
+    addField(3, c, 3, UF_INT);
   }
 
-  draw4(l0, l1, l2, l3);
+  fieldX100(F_REC, rec_u_x100);
+  fieldX100(F_SET, set_u_x100);
+  fieldInt(F_POTMIN, Fx100::fromRaw(potMin_u_x100).whole());
+  fieldInt(F_POTMAX, Fx100::fromRaw(potMax_u_x100).whole());
+  uiFlush();
 }
 
 // === RUN ===
+// RUN: <ON|OFF> <мл>ml       (мл — только если есть калибровка)
+// Rec:<x.xx>  <режим>
+// Set:<x.xx>  D:<мм>
 void uiDrawRun(const Settings &S,
                int32_t rec_u_x100,
                int32_t set_u_x100,
-               bool running) {
-  char l0[21], l1[21], l2[21], l3[21];
-
-  {
-    char b[32];
-    char runLabelBuf[16], onBuf[16], offBuf[16], modeBuf[16];
-    uiStrFromProgmem(runLabelBuf, sizeof(runLabelBuf), UI_STR_RUN_EN, UI_STR_RUN_UA);
-    uiStrFromProgmem(onBuf, sizeof(onBuf), UI_STR_RUN_ON_EN, UI_STR_RUN_ON_UA);
-    uiStrFromProgmem(offBuf, sizeof(offBuf), UI_STR_RUN_OFF_EN, UI_STR_RUN_OFF_UA);
-    snprintf(b, sizeof(b), "%s: %s", runLabelBuf, running ? onBuf : offBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l0, converted);
-  }
-
-  {
-    char b[32];
-    char modeBuf[16];
-    modeStr(modeBuf, sizeof(modeBuf), S);
-    snprintf(b, sizeof(b), "Rec:%ld.%02ld  %s",
-             (long)(rec_u_x100 / 100),
-             (long)(abs(rec_u_x100) % 100),
-             modeBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
-  }
-
-  {
-    char b[32];
-    snprintf(b, sizeof(b), "Set:%ld.%02ld  D:%u",
-             (long)(set_u_x100 / 100),
-             (long)(abs(set_u_x100) % 100),
-             (unsigned)S.cutter_mm);
-    pad20(l2, b);
+               bool running,
+               int32_t job_ml_x100) {
+  enum { F_RUN, F_ML, F_REC, F_MODE, F_SET, F_DIA };
+  bool showMl = (job_ml_x100 >= 0);
+
+  if (screenEnter(SCR_RUN, showMl)) {
+    uint8_t c = putP(0, 0, UI_STR_PTR(UI_STR_RUN_EN, UI_STR_RUN_UA));
+    c = putP(0, c, PSTR(": "));
+    c = addField(0, c, maxLenP(UI_STR_PTR(UI_STR_RUN_ON_EN, UI_STR_RUN_ON_UA),
+                               UI_STR_PTR(UI_STR_RUN_OFF_EN, UI_STR_RUN_OFF_UA)), UF_TEXT);
+    if (showMl) {
+      // вылито за эту работу; ширина — сколько осталось до единиц
+      const char* ml_P = UI_STR_PTR(UI_STR_ML_EN, UI_STR_ML_UA);
+      uint8_t used = c + 1 + strlen_P(ml_P);
+      uint8_t room = (used < 20) ? (uint8_t)(20 - used) : 0;
+      c = addField(0, c + 1, (room < 9) ? room : 9, UF_X100);
+      putP(0, c, ml_P);
+    } else {
+      addField(0, c, 0, UF_X100);
+    }
+
+    c = putP(1, 0, PSTR("Rec:"));
+    c = addField(1, c, 6, UF_X100);
+    addField(1, c + 2, modeWidth(), UF_TEXT);
+
+    c = putP(2, 0, PSTR("Set:"));
+    c = addField(2, c, 6, UF_X100);
+    c = putP(2, c, PSTR("  D:"));
+    addField(2, c, 2, UF_INT);
+
+    c = putP(3, 0, UI_STR_PTR(UI_STR_START_TOGGLE_EN, UI_STR_START_TOGGLE_UA));
+    putP(3, c + 2, UI_STR_PTR(UI_STR_OK_MENU_EN, UI_STR_OK_MENU_UA));
   }
 
-  {
-    char b[32];
-    char startToggleBuf[16], okMenuBuf[16];
-    uiStrFromProgmem(startToggleBuf, sizeof(startToggleBuf), UI_STR_START_TOGGLE_EN, UI_STR_START_TOGGLE_UA);
-    uiStrFromProgmem(okMenuBuf, sizeof(okMenuBuf), UI_STR_OK_MENU_EN, UI_STR_OK_MENU_UA);
-    snprintf(b, sizeof(b), "%s  %s", startToggleBuf, okMenuBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l3, converted);
-  }
-  draw4(l0, l1, l2, l3);
+  fieldText(F_RUN, running, running ? UI_STR_PTR(UI_STR_RUN_ON_EN, UI_STR_RUN_ON_UA)
+                                    : UI_STR_PTR(UI_STR_RUN_OFF_EN, UI_STR_RUN_OFF_UA));
+  if (showMl) fieldX100(F_ML, job_ml_x100);
+  fieldX100(F_REC, rec_u_x100);
+  fieldText(F_MODE, S.mode, modeStr_P(S));
+  fieldX100(F_SET, set_u_x100);
+  fieldInt(F_DIA, S.cutter_mm);
+  uiFlush();
 }
 
 // === MENU ===
+// Строки меню собирает menu.cpp; сюда они приходят целиком и сравниваются
+// с want4, отправляются только изменённые
 void uiDrawMenu(bool editing,
                 const char line1[21],
                 const char line2[21],
                 const char line3[21]) {
+  screenEnter(SCR_MENU);
+
   char l0[21];
   const char* menuTitle_P = editing 
     ? UI_STR_PTR(UI_STR_MENU_EDIT_EN, UI_STR_MENU_EDIT_UA)
     : UI_STR_PTR(UI_STR_MENU_EN, UI_STR_MENU_UA);
-  pad20_P(l0, menuTitle_P);
+  memset(l0, ' ', 20);
+  strncpy_P(l0, menuTitle_P, 20);
+  for (uint8_t i = 0; i < 20; i++) if (l0[i] == '\0') l0[i] = ' ';
+  l0[20] = '\0';
   draw4(l0, line1, line2, line3);
 }
 
 // === CALIBRATION ===
+// Total: <сек>s
+// Left : <сек>s   (обратный отсчёт)
 void uiDrawCalRun(uint16_t totalSec, uint16_t secondsLeft) {
-  char l0[21], l1[21], l2[21], l3[21];
+  enum { F_TOTAL, F_LEFT };
 
-  pad20_P(l0, UI_STR_PTR(UI_STR_CAL_RUN_EN, UI_STR_CAL_RUN_UA));
-
-  {
-    char b[32];
-    char totalLabelBuf[16], sUnitBuf[8];
-    uiStrFromProgmem(totalLabelBuf, sizeof(totalLabelBuf), UI_STR_TOTAL_EN, UI_STR_TOTAL_UA);
-    uiStrFromProgmem(sUnitBuf, sizeof(sUnitBuf), UI_STR_S_EN, UI_STR_S_UA);
-    snprintf(b, sizeof(b), "%s %u%s", totalLabelBuf, (unsigned)totalSec, sUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
-  }
+  if (screenEnter(SCR_CAL_RUN)) {
+    putP(0, 0, UI_STR_PTR(UI_STR_CAL_RUN_EN, UI_STR_CAL_RUN_UA));
+
+    uint8_t c = putP(1, 0, UI_STR_PTR(UI_STR_TOTAL_EN, UI_STR_TOTAL_UA));
+    c = addField(1, c + 1, 3, UF_INT);
+    putP(1, c, UI_STR_PTR(UI_STR_S_EN, UI_STR_S_UA));
+
+    c = putP(2, 0, UI_STR_PTR(UI_STR_LEFT_EN, UI_STR_LEFT_UA));
+    c = addField(2, c + 1, 3, UF_INT);
+    putP(2, c, UI_STR_PTR(UI_STR_S_EN, UI_STR_S_UA));
 
-  {
-    char b[64];  // Increased from 32 to 64 to ensure full string fits
-    char leftLabelBuf[32], sUnitBuf[8];  // Increased leftLabelBuf from 16 to 32 bytes
-    uiStrFromProgmem(leftLabelBuf, sizeof(leftLabelBuf), UI_STR_LEFT_EN, UI_STR_LEFT_UA);
-    uiStrFromProgmem(sUnitBuf, sizeof(sUnitBuf), UI_STR_S_EN, UI_STR_S_UA);
-    snprintf(b, sizeof(b), "%s %u%s", leftLabelBuf, (unsigned)secondsLeft, sUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l2, converted);
+    putP(3, 0, UI_STR_PTR(UI_STR_MENU_ABORT_EN, UI_STR_MENU_ABORT_UA));
   }
 
-  pad20_P(l3, UI_STR_PTR(UI_STR_MENU_ABORT_EN, UI_STR_MENU_ABORT_UA));
-  draw4(l0, l1, l2, l3);
+  fieldInt(F_TOTAL, totalSec);
+  fieldInt(F_LEFT, secondsLeft);
+  uiFlush();
 }
 
+// Value: <x.xx> ml
+// Digit: <n>
 void uiDrawCalInputDigits(int32_t ml_x100, uint8_t digitIdx) {
-  char l0[21], l1[21], l2[21], l3[21];
+  enum { F_VALUE, F_DIGIT };
 
-  pad20_P(l0, UI_STR_PTR(UI_STR_CAL_INPUT_EN, UI_STR_CAL_INPUT_UA));
-
-  int32_t w = ml_x100 / 100;
-  int32_t f = abs(ml_x100) % 100;
-
-  {
-    char b[64];  // Increased from 32 to 64 to ensure full string fits
-    char valueLabelBuf[32], mlUnitBuf[8];  // Increased valueLabelBuf from 16 to 32 bytes
-    uiStrFromProgmem(valueLabelBuf, sizeof(valueLabelBuf), UI_STR_VALUE_EN, UI_STR_VALUE_UA);
-    uiStrFromProgmem(mlUnitBuf, sizeof(mlUnitBuf), UI_STR_ML_EN, UI_STR_ML_UA);
-    snprintf(b, sizeof(b), "%s %ld.%02ld %s", valueLabelBuf, (long)w, (long)f, mlUnitBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l1, converted);
-  }
+  if (screenEnter(SCR_CAL_INPUT)) {
+    putP(0, 0, UI_STR_PTR(UI_STR_CAL_INPUT_EN, UI_STR_CAL_INPUT_UA));
+
+    uint8_t c = putP(1, 0, UI_STR_PTR(UI_STR_VALUE_EN, UI_STR_VALUE_UA));
+    c = addField(1, c + 1, 6, UF_X100);
+    putP(1, c + 1, UI_STR_PTR(UI_STR_ML_EN, UI_STR_ML_UA));
 
-  {
-    char b[64];  // Increased from 32 to 64
-    char digitLabelBuf[32];  // Increased from 16 to 32 bytes
-    uiStrFromProgmem(digitLabelBuf, sizeof(digitLabelBuf), UI_STR_DIGIT_EN, UI_STR_DIGIT_UA);
-    snprintf(b, sizeof(b), "%s %u", digitLabelBuf, (unsigned)digitIdx);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l2, converted);
+    c = putP(2, 0, UI_STR_PTR(UI_STR_DIGIT_EN, UI_STR_DIGIT_UA));
+    addField(2, c + 1, 1, UF_INT);
+
+    c = putP(3, 0, UI_STR_PTR(UI_STR_TURN_CHG_EN, UI_STR_TURN_CHG_UA));
+    putP(3, c + 1, UI_STR_PTR(UI_STR_OK_NEXT_MENU_EN, UI_STR_OK_NEXT_MENU_UA));
   }
 
-  {
-    char b[64];  // Increased from 32 to 64
-    char turnChgBuf[32], okNextMenuBuf[32];  // Increased from 16 to 32 bytes
-    uiStrFromProgmem(turnChgBuf, sizeof(turnChgBuf), UI_STR_TURN_CHG_EN, UI_STR_TURN_CHG_UA);
-    uiStrFromProgmem(okNextMenuBuf, sizeof(okNextMenuBuf), UI_STR_OK_NEXT_MENU_EN, UI_STR_OK_NEXT_MENU_UA);
-    snprintf(b, sizeof(b), "%s %s", turnChgBuf, okNextMenuBuf);
-    
-    // Convert UTF-8 to LCD encoding before padding
-    char converted[64];
-    uiConvertUtf8ToAscii(converted, b, sizeof(converted));
-    pad20(l3, converted);
+  fieldX100(F_VALUE, ml_x100);
+  fieldInt(F_DIGIT, digitIdx);
+  uiFlush();
+}
+#if PROF_ENABLE
+// === DIAG (профайлер) ===
+// DIAG 1/9 loop
+// min   12 max   1234    мкс
+// avg   34 n  123456
+// H 0139520000           гистограмма 0..9, бакеты <16,<32..>=1024 мкс
+static void padRow(char out[21]) {
+  uint8_t n = strlen(out);
+  if (n < 20) memset(out + n, ' ', 20 - n);
+  out[20] = '\0';
+}
+
+void uiDrawDiag(uint8_t page) {
+  char l0[21], l1[21], l2[21], l3[21];
+  char name[12];
+  ProfStat st;
+
+  if (page >= PROF_COUNT) page = PROF_COUNT - 1;
+  profGet(page, st);
+  strncpy_P(name, profName_P(page), sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+
+  // тики по 4 мкс
+  uint32_t mn = st.n ? (uint32_t)st.minT * 4 : 0;
+  uint32_t mx = (uint32_t)st.maxT * 4;
+  uint32_t avg = st.n ? st.sumT * 4 / st.n : 0;
+
+  snprintf(l0, sizeof(l0), "DIAG %u/%u %s", page + 1, (unsigned)PROF_COUNT, name);
+  snprintf(l1, sizeof(l1), "min%6lu max%7lu", (unsigned long)mn, (unsigned long)mx);
+  snprintf(l2, sizeof(l2), "avg%6lu n%9lu", (unsigned long)avg, (unsigned long)st.n);
+
+  uint16_t top = 0;
+  for (uint8_t b = 0; b < PROF_BUCKETS; b++) if (st.hist[b] > top) top = st.hist[b];
+  strcpy_P(l3, PSTR("H "));
+  for (uint8_t b = 0; b < PROF_BUCKETS; b++) {
+    // непустой бакет — хотя бы '1', чтобы редкие выбросы были видны
+    uint8_t d = top ? (uint8_t)((uint32_t)st.hist[b] * 9 / top) : 0;
+    if (d == 0 && st.hist[b]) d = 1;
+    l3[2 + b] = (char)('0' + d);
   }
+  l3[2 + PROF_BUCKETS] = '\0';
+
+  padRow(l0); padRow(l1); padRow(l2); padRow(l3);
+  screenEnter(SCR_DIAG);
   draw4(l0, l1, l2, l3);
 }
-#include <avr/pgmspace.h>
+#endif
 
-static void uiPrintHex2(uint8_t v) {
+// === LCD TEST ===
+// Тоже через теневой буфер: без lcd.clear() (нет мигания), при прокрутке
+// уходят только изменившиеся символы
+static void lcdTestRow(char out[21], uint8_t base) {
   static const char hexdig[] PROGMEM = "0123456789ABCDEF";
-  char a = pgm_read_byte(&hexdig[(v >> 4) & 0x0F]);
-  char b = pgm_read_byte(&hexdig[v & 0x0F]);
-  lcd.write(a);
-  lcd.write(b);
-}
-
-static void uiDrawLcdTestRow(uint8_t row, uint8_t base) {
-  lcd.setCursor(0, row);
 
   // Show hex code like "80:"
-  uiPrintHex2(base);
-  lcd.write(':');
-  lcd.write(' ');
+  out[0] = pgm_read_byte(&hexdig[(base >> 4) & 0x0F]);
+  out[1] = pgm_read_byte(&hexdig[base & 0x0F]);
+  out[2] = ':';
+  out[3] = ' ';
 
   // Display 16 characters (base..base+15)
   for (uint8_t i = 0; i < 16; i++) {
-    lcd.write((uint8_t)(base + i));
+    out[4 + i] = (char)(base + i);
   }
+  out[20] = '\0';
 }
 
 void uiDrawLcdTest(uint8_t base) {
-  lcd.clear();
-  uiDrawLcdTestRow(0, base);
-  uiDrawLcdTestRow(1, (uint8_t)(base + 0x10));
-  uiDrawLcdTestRow(2, (uint8_t)(base + 0x20));
-  uiDrawLcdTestRow(3, (uint8_t)(base + 0x30));
+  char l0[21], l1[21], l2[21], l3[21];
+  screenEnter(SCR_LCD_TEST);
+  lcdTestRow(l0, base);
+  lcdTestRow(l1, (uint8_t)(base + 0x10));
+  lcdTestRow(l2, (uint8_t)(base + 0x20));
+  lcdTestRow(l3, (uint8_t)(base + 0x30));
+  draw4(l0, l1, l2, l3);
 }
 
 // Test function to display specific Cyrillic letters with their byte codes
 // This helps determine exact encoding for each letter
 void uiDrawCyrillicTest() {
-  lcd.clear();
-  
   // Line 0: Test word "ГОТОВО" with different byte codes
-  lcd.setCursor(0, 0);
-  lcd.write((uint8_t)0x80); // Try А
-  lcd.write((uint8_t)0x81); // Try Б
-  lcd.write((uint8_t)0x82); // Try В
-  lcd.write((uint8_t)0x83); // Try Г
-  lcd.write((uint8_t)0x84); // Try Д
-  lcd.write((uint8_t)0x85); // Try Е
-  lcd.write(' ');
-  lcd.write((uint8_t)0x83); // Г
-  lcd.write((uint8_t)0x8E); // О
-  lcd.write((uint8_t)0x92); // Т
-  lcd.write((uint8_t)0x8E); // О
-  lcd.write((uint8_t)0x82); // В
-  lcd.write((uint8_t)0x8E); // О
-  
+  static const char t0[] PROGMEM =
+    "\x80\x81\x82\x83\x84\x85"   // Try А Б В Г Д Е
+    " "
+    "\x83\x8E\x92\x8E\x82\x8E";  // Г О Т О В О
   // Line 1: Show codes for Г-О-Т-О-В-О
-  lcd.setCursor(0, 1);
-  lcd.print("G 0x83 O 0x8E T 0x92");
-  
+  static const char t1[] PROGMEM = "G 0x83 O 0x8E T 0x92";
   // Line 2: Test lowercase
-  lcd.setCursor(0, 2);
-  lcd.write((uint8_t)0xA1); // Try а
-  lcd.write((uint8_t)0xA2); // Try б
-  lcd.write((uint8_t)0xA3); // Try в
-  lcd.write((uint8_t)0xA4); // Try г
-  lcd.write((uint8_t)0xA5); // Try д
-  lcd.write((uint8_t)0xA6); // Try е
-  lcd.write(' ');
-  lcd.write((uint8_t)0xB0); // Try п
-  lcd.write((uint8_t)0xB1); // Try р
-  lcd.write((uint8_t)0xB8); // Try ч (if from test)
-  
+  static const char t2[] PROGMEM =
+    "\xA1\xA2\xA3\xA4\xA5\xA6"   // Try а б в г д е
+    " "
+    "\xB0\xB1\xB8";              // Try п р ч (if from test)
   // Line 3: Instructions
-  lcd.setCursor(0, 3);
-  lcd.print("Check codes above");
+  static const char t3[] PROGMEM = "Check codes above";
+
+  screenEnter(SCR_LCD_TEST);
+  putP(0, 0, t0);
+  putP(1, 0, t1);
+  putP(2, 0, t2);
+  putP(3, 0, t3);
+  uiFlush();
 }
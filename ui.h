@@ -1,15 +1,26 @@
 #pragma once
+#include "config.h"
 #include "types.h"
 #include <Arduino.h>
 
 void uiBegin();
-void uiClear();
+void uiClear();   // новый экран; сам LCD не очищается, перепишется diff'ом
+
+// Перерисовка по событию: после изменения показываемых данных зовём
+// uiInvalidate(), loop() строит кадр, когда uiRedrawDue()
+void uiInvalidate();
+bool uiRedrawDue();               // есть что рисовать, LCD свободен, лимит кадров выдержан
+
+// Диагностика: сколько байт (символы + команды) ушло на LCD
+uint16_t uiGetLastFrameBytes();   // за последний кадр
+uint32_t uiGetLcdBytesTotal();    // с включения
+uint32_t uiGetLcdCmdTotal();      // команд HD44780 (setCursor, clear) с включения
 
 void uiDrawReady(const Settings &S);
 void uiDrawWizMaterial(const Settings &S);
 void uiDrawWizDiameter(const Settings &S);
 void uiDrawWizRecommend(const Settings &S, int32_t rec_u_x100, int32_t set_u_x100, int32_t potMin_u_x100, int32_t potMax_u_x100);
-void uiDrawRun(const Settings &S, int32_t rec_u_x100, int32_t set_u_x100, bool running);
+void uiDrawRun(const Settings &S, int32_t rec_u_x100, int32_t set_u_x100, bool running, int32_t job_ml_x100); // job_ml_x100 < 0: нет калибровки
 
 void uiDrawMenu(bool editing, const char line1[21], const char line2[21], const char line3[21]);
 
@@ -20,5 +31,10 @@ void uiDrawCalInputDigits(int32_t ml_x100, uint8_t digitIdx); // digitIdx 0..3
 void uiDrawLcdTest(uint8_t base);
 void uiDrawLcdTest(uint8_t base);   // base = 0xA0..0xFF
 
+#if PROF_ENABLE
+// Профайлер (prof.h): page = ProfId, min/avg/max в мкс + гистограмма
+void uiDrawDiag(uint8_t page);
+#endif
+
 // Test function to display specific Cyrillic letters with their codes
 void uiDrawCyrillicTest();
\ No newline at end of file
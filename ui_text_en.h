@@ -44,6 +44,7 @@ static const char UI_STR_LEFT_EN[] PROGMEM = "Left :";
 static const char UI_STR_VALUE_EN[] PROGMEM = "Value:";
 static const char UI_STR_DIGIT_EN[] PROGMEM = "Digit:";
 static const char UI_STR_ML_EN[] PROGMEM = "ml";
+static const char UI_STR_L_EN[] PROGMEM = "L";
 
 // === Menu items ===
 static const char UI_STR_MENU_MATERIAL_EN[] PROGMEM = "Material:";
@@ -51,23 +52,28 @@ static const char UI_STR_MENU_CUTTER_EN[] PROGMEM = "Cutter D:";
 static const char UI_STR_MENU_MODE_EN[] PROGMEM = "Mode:";
 static const char UI_STR_MENU_PULSE_ON_EN[] PROGMEM = "Pulse ON:";
 static const char UI_STR_MENU_PULSE_OFF_EN[] PROGMEM = "Pulse OFF:";
+static const char UI_STR_MENU_PULSE_AVG_EN[] PROGMEM = "Pulse avg:";
 static const char UI_STR_MENU_KMIN_EN[] PROGMEM = "Kmin:";
 static const char UI_STR_MENU_KMAX_EN[] PROGMEM = "Kmax:";
 static const char UI_STR_MENU_ALFACTOR_EN[] PROGMEM = "AlFactor:";
 static const char UI_STR_MENU_POT_AVG_EN[] PROGMEM = "POT Avg N:";
 static const char UI_STR_MENU_POT_HYST_EN[] PROGMEM = "POT Hyst:";
 static const char UI_STR_MENU_PUMPGAIN_EN[] PROGMEM = "PumpGain:";
+static const char UI_STR_MENU_ACCEL_EN[] PROGMEM = "Accel/s2:";
+static const char UI_STR_MENU_DECEL_EN[] PROGMEM = "Decel/s2:";
 static const char UI_STR_MENU_CAL_60_EN[] PROGMEM = "Calibrate 60s";
 static const char UI_STR_MENU_CAL_120_EN[] PROGMEM = "Calibrate 120s";
 static const char UI_STR_MENU_CAL_MLU_EN[] PROGMEM = "Cal ml/u:";
 static const char UI_STR_MENU_CAL_NONE_EN[] PROGMEM = "(none)";
 static const char UI_STR_MENU_CLEAR_CAL_EN[] PROGMEM = "Clear calibration";
+static const char UI_STR_MENU_OIL_TOTAL_EN[] PROGMEM = "Oil total:";
 static const char UI_STR_MENU_SAVE_EN[] PROGMEM = "Save EEPROM";
 static const char UI_STR_MENU_DEFAULTS_EN[] PROGMEM = "Load Defaults";
 static const char UI_STR_MENU_LANGUAGE_EN[] PROGMEM = "Language:";
 static const char UI_STR_MENU_LANG_EN_EN[] PROGMEM = "EN";
 static const char UI_STR_MENU_LANG_UA_EN[] PROGMEM = "UA";
 static const char UI_STR_MENU_LCD_TEST_EN[] PROGMEM = "LCD Test";
+static const char UI_STR_MENU_DIAG_EN[] PROGMEM = "Diagnostics";
 
 // === Units ===
 static const char UI_STR_MM_EN[] PROGMEM = "mm";
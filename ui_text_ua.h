@@ -1,77 +1,84 @@
+// СГЕНЕРИРОВАНО tools/gen_ui_text_ua.py из tools/ui_text_ua.utf8.h — не править руками.
+// Строки уже в кодах знакогенератора LCD (в комментарии — исходный текст).
 #pragma once
 #include <avr/pgmspace.h>
 
 // Russian UI strings (stored in PROGMEM to save RAM)
-// Using Cyrillic UTF-8 encoding
 
 // === Material names ===
-static const char UI_STR_STEEL_UA[] PROGMEM = "Сталь";
-static const char UI_STR_ALUMINUM_UA[] PROGMEM = "Алюмин";
+static const char UI_STR_STEEL_UA[] PROGMEM = "C\277a\273\304"; // Сталь
+static const char UI_STR_ALUMINUM_UA[] PROGMEM = "A\273\306\274\270\275"; // Алюмин
 
 // === Mode names ===
-static const char UI_STR_CONT_UA[] PROGMEM = "БЕЗПРЕР";
-static const char UI_STR_PULSE_UA[] PROGMEM = "ИМПУЛЬС";
+static const char UI_STR_CONT_UA[] PROGMEM = "\240E\244\250PEP"; // БЕЗПРЕР
+static const char UI_STR_PULSE_UA[] PROGMEM = "\245M\250\251\247bC"; // ИМПУЛЬС
 
 // === Screen titles ===
-static const char UI_STR_READY_UA[] PROGMEM = "ГОТОВО";
-static const char UI_STR_MENU_UA[] PROGMEM = "МЕНЮ";
-static const char UI_STR_MENU_EDIT_UA[] PROGMEM = "МЕНЮ (РЕД)";
-static const char UI_STR_WIZ_MAT_UA[] PROGMEM = "МАСТЕР: МАТЕРИАЛ";
-static const char UI_STR_WIZ_DIA_UA[] PROGMEM = "МАСТЕР: ФРЕЗА O";
-static const char UI_STR_WIZ_REC_UA[] PROGMEM = "МАСТЕР: РЕКОМЕНД";
-static const char UI_STR_RUN_UA[] PROGMEM = "РАБОТА";
-static const char UI_STR_RUN_ON_UA[] PROGMEM = "ВКЛ";
-static const char UI_STR_RUN_OFF_UA[] PROGMEM = "ВЫКЛ";
-static const char UI_STR_CAL_RUN_UA[] PROGMEM = "КАЛИБРОВКА";
-static const char UI_STR_CAL_INPUT_UA[] PROGMEM = "КАЛ: ВВЕДИТЕ мл";
+static const char UI_STR_READY_UA[] PROGMEM = "\241OTOBO"; // ГОТОВО
+static const char UI_STR_MENU_UA[] PROGMEM = "MEH\260"; // МЕНЮ
+static const char UI_STR_MENU_EDIT_UA[] PROGMEM = "MEH\260 (PED)"; // МЕНЮ (РЕД)
+static const char UI_STR_WIZ_MAT_UA[] PROGMEM = "MACTEP: MATEP\245A\247"; // МАСТЕР: МАТЕРИАЛ
+static const char UI_STR_WIZ_DIA_UA[] PROGMEM = "MACTEP: \252PE\244A O"; // МАСТЕР: ФРЕЗА O
+static const char UI_STR_WIZ_REC_UA[] PROGMEM = "MACTEP: PEKOMEHD"; // МАСТЕР: РЕКОМЕНД
+static const char UI_STR_RUN_UA[] PROGMEM = "PA\240OTA"; // РАБОТА
+static const char UI_STR_RUN_ON_UA[] PROGMEM = "BK\247"; // ВКЛ
+static const char UI_STR_RUN_OFF_UA[] PROGMEM = "B\256K\247"; // ВЫКЛ
+static const char UI_STR_CAL_RUN_UA[] PROGMEM = "KA\247\245\240POBKA"; // КАЛИБРОВКА
+static const char UI_STR_CAL_INPUT_UA[] PROGMEM = "KA\247: BBED\245TE \274\273"; // КАЛ: ВВЕДИТЕ мл
 
 // === Labels ===
-static const char UI_STR_MAT_UA[] PROGMEM = "Мат:";
-static const char UI_STR_MODE_UA[] PROGMEM = "Реж:";
-static const char UI_STR_TURN_CHANGE_UA[] PROGMEM = "Пов: изменить";
-static const char UI_STR_OK_NEXT_UA[] PROGMEM = "OK:Далее";
-static const char UI_STR_MENU_BACK_UA[] PROGMEM = "МЕНЮ:Назад";
-static const char UI_STR_START_TOGGLE_UA[] PROGMEM = "ПУСК:Перекл";
-static const char UI_STR_OK_MENU_UA[] PROGMEM = "OK:Меню";
-static const char UI_STR_START_RUN_UA[] PROGMEM = "ПУСК:Старт";
-static const char UI_STR_OK_MENU_START_UA[] PROGMEM = "OK:Меню  ПУСК:Старт";
-static const char UI_STR_MENU_ABORT_UA[] PROGMEM = "МЕНЮ:Отмена";
-static const char UI_STR_TURN_CHG_UA[] PROGMEM = "Пов:изм";
-static const char UI_STR_OK_NEXT_MENU_UA[] PROGMEM = "OK:Далее МЕНЮ";
+static const char UI_STR_MAT_UA[] PROGMEM = "Ma\277:"; // Мат:
+static const char UI_STR_MODE_UA[] PROGMEM = "Pe\266:"; // Реж:
+static const char UI_STR_TURN_CHANGE_UA[] PROGMEM = "\250o\263: \270\267\274e\275\270\277\304"; // Пов: изменить
+static const char UI_STR_OK_NEXT_UA[] PROGMEM = "OK:Da\273ee"; // OK:Далее
+static const char UI_STR_MENU_BACK_UA[] PROGMEM = "MEH\260:Ha\267ad"; // МЕНЮ:Назад
+static const char UI_STR_START_TOGGLE_UA[] PROGMEM = "\250\251CK:\250epe\272\273"; // ПУСК:Перекл
+static const char UI_STR_OK_MENU_UA[] PROGMEM = "OK:Me\275\306"; // OK:Меню
+static const char UI_STR_START_RUN_UA[] PROGMEM = "\250\251CK:C\277ap\277"; // ПУСК:Старт
+static const char UI_STR_OK_MENU_START_UA[] PROGMEM = "OK:Me\275\306  \250\251CK:C\277ap\277"; // OK:Меню  ПУСК:Старт
+static const char UI_STR_MENU_ABORT_UA[] PROGMEM = "MEH\260:O\277\274e\275a"; // МЕНЮ:Отмена
+static const char UI_STR_TURN_CHG_UA[] PROGMEM = "\250o\263:\270\267\274"; // Пов:изм
+static const char UI_STR_OK_NEXT_MENU_UA[] PROGMEM = "OK:Da\273ee MEH\260"; // OK:Далее МЕНЮ
 
 // === Calibration ===
-static const char UI_STR_TOTAL_UA[] PROGMEM = "Всего:";
-static const char UI_STR_LEFT_UA[] PROGMEM = "Осталось:";
-static const char UI_STR_VALUE_UA[] PROGMEM = "Значение:";
-static const char UI_STR_DIGIT_UA[] PROGMEM = "Разряд:";
-static const char UI_STR_ML_UA[] PROGMEM = "мл";
+static const char UI_STR_TOTAL_UA[] PROGMEM = "Bce\264o:"; // Всего:
+static const char UI_STR_LEFT_UA[] PROGMEM = "Oc\277a\273oc\304:"; // Осталось:
+static const char UI_STR_VALUE_UA[] PROGMEM = "\244\275a\300e\275\270e:"; // Значение:
+static const char UI_STR_DIGIT_UA[] PROGMEM = "Pa\267p\307d:"; // Разряд:
+static const char UI_STR_ML_UA[] PROGMEM = "\274\273"; // мл
+static const char UI_STR_L_UA[] PROGMEM = "\273"; // л
 
 // === Menu items ===
-static const char UI_STR_MENU_MATERIAL_UA[] PROGMEM = "Материал:";
-static const char UI_STR_MENU_CUTTER_UA[] PROGMEM = "Фреза D:";
-static const char UI_STR_MENU_MODE_UA[] PROGMEM = "Режим:";
-static const char UI_STR_MENU_PULSE_ON_UA[] PROGMEM = "Имп ВКЛ:";
-static const char UI_STR_MENU_PULSE_OFF_UA[] PROGMEM = "Имп ВЫКЛ:";
-static const char UI_STR_MENU_KMIN_UA[] PROGMEM = "Kmin:";
-static const char UI_STR_MENU_KMAX_UA[] PROGMEM = "Kmax:";
-static const char UI_STR_MENU_ALFACTOR_UA[] PROGMEM = "AlКоэф:";
-static const char UI_STR_MENU_POT_AVG_UA[] PROGMEM = "ПОТ Среднее:";
-static const char UI_STR_MENU_POT_HYST_UA[] PROGMEM = "ПОТ Гист:";
-static const char UI_STR_MENU_PUMPGAIN_UA[] PROGMEM = "НасосКоэф:";
-static const char UI_STR_MENU_CAL_60_UA[] PROGMEM = "Калибр 60с";
-static const char UI_STR_MENU_CAL_120_UA[] PROGMEM = "Калибр 120с";
-static const char UI_STR_MENU_CAL_MLU_UA[] PROGMEM = "Кал мл/у:";
-static const char UI_STR_MENU_CAL_NONE_UA[] PROGMEM = "(нет)";
-static const char UI_STR_MENU_CLEAR_CAL_UA[] PROGMEM = "Очистить калибр";
-static const char UI_STR_MENU_SAVE_UA[] PROGMEM = "Сохранить EEPROM";
-static const char UI_STR_MENU_DEFAULTS_UA[] PROGMEM = "По умолчанию";
-static const char UI_STR_MENU_LANGUAGE_UA[] PROGMEM = "Язык:";
-static const char UI_STR_MENU_LANG_EN_UA[] PROGMEM = "АНГ";
-static const char UI_STR_MENU_LANG_UA_UA[] PROGMEM = "РУС";
-static const char UI_STR_MENU_LCD_TEST_UA[] PROGMEM = "Тест LCD";
+static const char UI_STR_MENU_MATERIAL_UA[] PROGMEM = "Ma\277ep\270a\273:"; // Материал:
+static const char UI_STR_MENU_CUTTER_UA[] PROGMEM = "\252pe\267a D:"; // Фреза D:
+static const char UI_STR_MENU_MODE_UA[] PROGMEM = "Pe\266\270\274:"; // Режим:
+static const char UI_STR_MENU_PULSE_ON_UA[] PROGMEM = "\245\274\276 BK\247:"; // Имп ВКЛ:
+static const char UI_STR_MENU_PULSE_OFF_UA[] PROGMEM = "\245\274\276 B\256K\247:"; // Имп ВЫКЛ:
+static const char UI_STR_MENU_PULSE_AVG_UA[] PROGMEM = "\245\274\276 cped\275:"; // Имп средн:
+static const char UI_STR_MENU_KMIN_UA[] PROGMEM = "Kmin:"; // Kmin:
+static const char UI_STR_MENU_KMAX_UA[] PROGMEM = "Kmax:"; // Kmax:
+static const char UI_STR_MENU_ALFACTOR_UA[] PROGMEM = "AlKo\305\252:"; // AlКоэф:
+static const char UI_STR_MENU_POT_AVG_UA[] PROGMEM = "\250OT Cped\275ee:"; // ПОТ Среднее:
+static const char UI_STR_MENU_POT_HYST_UA[] PROGMEM = "\250OT \241\270c\277:"; // ПОТ Гист:
+static const char UI_STR_MENU_PUMPGAIN_UA[] PROGMEM = "HacocKo\305\252:"; // НасосКоэф:
+static const char UI_STR_MENU_ACCEL_UA[] PROGMEM = "Pa\267\264o\275/c2:"; // Разгон/с2:
+static const char UI_STR_MENU_DECEL_UA[] PROGMEM = "Top\274o\267/c2:"; // Тормоз/с2:
+static const char UI_STR_MENU_CAL_60_UA[] PROGMEM = "Ka\273\270\262p 60c"; // Калибр 60с
+static const char UI_STR_MENU_CAL_120_UA[] PROGMEM = "Ka\273\270\262p 120c"; // Калибр 120с
+static const char UI_STR_MENU_CAL_MLU_UA[] PROGMEM = "Ka\273 \274\273/y:"; // Кал мл/у:
+static const char UI_STR_MENU_CAL_NONE_UA[] PROGMEM = "(\275e\277)"; // (нет)
+static const char UI_STR_MENU_CLEAR_CAL_UA[] PROGMEM = "O\300\270c\277\270\277\304 \272a\273\270\262p"; // Очистить калибр
+static const char UI_STR_MENU_OIL_TOTAL_UA[] PROGMEM = "Pacxod:"; // Расход:
+static const char UI_STR_MENU_SAVE_UA[] PROGMEM = "Coxpa\275\270\277\304 EEPROM"; // Сохранить EEPROM
+static const char UI_STR_MENU_DEFAULTS_UA[] PROGMEM = "\250o y\274o\273\300a\275\270\306"; // По умолчанию
+static const char UI_STR_MENU_LANGUAGE_UA[] PROGMEM = "\261\267\303\272:"; // Язык:
+static const char UI_STR_MENU_LANG_EN_UA[] PROGMEM = "AH\241"; // АНГ
+static const char UI_STR_MENU_LANG_UA_UA[] PROGMEM = "P\251C"; // РУС
+static const char UI_STR_MENU_LCD_TEST_UA[] PROGMEM = "Tec\277 LCD"; // Тест LCD
+static const char UI_STR_MENU_DIAG_UA[] PROGMEM = "D\270a\264\275oc\277\270\272a"; // Диагностика
 
 // === Units ===
-static const char UI_STR_MM_UA[] PROGMEM = "мм";
-static const char UI_STR_U_UA[] PROGMEM = "у";
-static const char UI_STR_MS_UA[] PROGMEM = "мс";
-static const char UI_STR_S_UA[] PROGMEM = "с";
+static const char UI_STR_MM_UA[] PROGMEM = "\274\274"; // мм
+static const char UI_STR_U_UA[] PROGMEM = "y"; // у
+static const char UI_STR_MS_UA[] PROGMEM = "\274c"; // мс
+static const char UI_STR_S_UA[] PROGMEM = "c"; // с